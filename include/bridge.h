@@ -27,6 +27,10 @@
 #include "ops-utils.h"
 
 struct simap;
+#ifdef OPS
+struct iface_rate;
+struct vrf;
+#endif
 
 #ifdef OPS
 struct bridge {
@@ -39,6 +43,7 @@ struct bridge {
 
     /* OpenFlow switch processing. */
     struct ofproto *ofproto;    /* OpenFlow switch. */
+    struct vrf *vrf;            /* VRF of this bridge, NULL if it is none. */
 
     /* Bridge ports. */
     struct hmap ports;          /* "struct port"s indexed by name. */
@@ -50,10 +55,18 @@ struct bridge {
 
     /* Bridge VLANs. */
     struct hmap vlans;          /* "struct vlan"s indexed by VID. */
+    unsigned long *vlans_present; /* Bitmap of the VIDs in 'vlans'. */
+    unsigned long *vlans_enabled; /* Bitmap of the VIDs enabled in ofproto. */
 
     /* Used during reconfiguration. */
     struct shash wanted_ports;
 
+    /* sFlow options last passed to ofproto_set_sflow(). */
+    bool sflow_set;             /* ofproto_set_sflow() called at least once. */
+    bool sflow_enabled;         /* Last call enabled sFlow. */
+    struct ofproto_sflow_options sflow_options; /* Copy of the options and */
+    struct sset sflow_ports;    /* ...names of the ports, if enabled. */
+
     /* Synthetic local port if necessary. */
     struct ovsrec_port synth_local_port;
     struct ovsrec_interface synth_local_iface;
@@ -73,6 +86,10 @@ struct port {
     struct ovs_list ifaces;    /* List of "struct iface"s. */
 #ifdef OPS
     int bond_hw_handle;        /* Hardware bond identifier. */
+    bool bundle_registered;    /* Registered with ofproto at least once. */
+    char *bundle_key;          /* port_bundle_key() of the registered */
+    size_t bundle_key_len;     /* settings, and its length. */
+    struct hmap_node global_node; /* In bridge.c's "all_ports_by_name". */
 #endif
 };
 
@@ -89,6 +106,19 @@ struct iface {
     struct netdev *netdev;      /* Network device. */
     ofp_port_t ofp_port;        /* OpenFlow port number. */
     uint64_t change_seq;
+#ifdef OPS
+    struct hmap_node global_node; /* In bridge.c's "all_ifaces_by_name". */
+    struct iface_rate *rate;    /* Smoothed rx/tx rates. */
+    long long int stats_due;    /* Next statistics poll, in msec. */
+    bool stats_refreshed;       /* Polled by the current stats slice. */
+    char *subintf_parent;       /* Parent applied to a subinterface netdev. */
+    struct hmap_node subintf_node; /* In bridge.c's "subintfs_by_parent",
+                                    * if 'subintf_parent' is nonnull. */
+    int subintf_vlan;           /* VLAN applied to a subinterface netdev. */
+#endif
+#ifdef OPS_TEMP
+    struct ovs_list status_elem; /* In bridge.c's "status_ifaces" list. */
+#endif
 
     /* These members are valid only within bridge_reconfigure(). */
     const char *type;           /* Usually same as cfg->type. */
@@ -122,6 +152,7 @@ void bridge_get_memory_usage(struct simap *usage);
 
 #ifdef OPS
 void wait_for_config_complete(void);
+void bridge_idl_track_clear(void);
 struct bridge* get_bridge_from_port_name (char *port_name, struct port **port);
 #endif
 
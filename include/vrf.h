@@ -59,6 +59,8 @@ struct route {
 
     struct vrf *vrf;
     struct uuid idl_row_uuid;       /* reference to idl uuid */
+    bool held;                      /* not programmed yet, see
+                                       vrf_set_route_hold() */
 };
 
 struct nexthop {
@@ -90,6 +92,8 @@ struct ecmp {
 
 void vrf_reconfigure_routes(struct vrf *vrf);
 void vrf_reconfigure_nexthops(struct vrf *vrf);
+void vrf_set_route_hold(bool hold);
+int vrf_release_held_routes(struct vrf *vrf);
 void vrf_ofproto_update_route_with_neighbor(struct vrf *vrf,
                                             struct neighbor *neighbor,
                                             bool resolved);
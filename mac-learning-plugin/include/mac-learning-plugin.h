@@ -22,20 +22,34 @@
 
 #define MAC_LEARNING_PLUGIN_INTERFACE_NAME "MAC_LEARNING_PLUGIN"
 #define MAC_LEARNING_PLUGIN_INTERFACE_MAJOR 1
-#define MAC_LEARNING_PLUGIN_INTERFACE_MINOR 0
+#define MAC_LEARNING_PLUGIN_INTERFACE_MINOR 1
+
+/* First minor version providing mac_learning_event_post. */
+#define MAC_LEARNING_PLUGIN_EVENT_POST_MINOR 1
+
+struct mlearn_event;
 
 /*
  * struct: mac_learning_plugin_interface
  *
  * This interface needs to hold the API function pointer definitions
  * so that it can be exposed.
+ *
+ * mac_learning_event_post may be called from any thread, and never blocks:
+ * it posts 'event' into a ring of the size set by
+ * "mac-learning-event-ring-size" in the Open_vSwitch other_config column.  It returns false if the ring is
+ * full, in which case the event is lost and the MAC table is resynced from
+ * the L2 table of the asic plugin.  Once done with a burst of events, the
+ * asic plugin calls mac_learning_trigger_callback to get them written.
  */
 struct mac_learning_plugin_interface {
     void (*mac_learning_trigger_callback) (void);
+    bool (*mac_learning_event_post) (const struct mlearn_event *event);
 };
 
 /*
- * Buffer size for hmap for mac learning
+ * Buffer size for hmap for mac learning, used by the asic plugins that
+ * provide get_mac_learning_hmap rather than post MAC events.
  */
 #define BUFFER_SIZE  16384
 
@@ -81,6 +95,16 @@ typedef enum mac_event_ {
     MLEARN_MOVE,       /* mac move event */
 } mac_event;
 
+/* MAC event posted through mac_learning_event_post. */
+struct mlearn_event {
+    struct eth_addr mac;            /* MAC address */
+    uint16_t vlan;                  /* VLAN */
+    uint8_t oper;                   /* action, a mac_event */
+    uint8_t hw_unit;                /* hw_unit */
+    int32_t port;                   /* port_id */
+    char port_name[PORT_NAME_SIZE]; /* Port name */
+};
+
 struct mlearn_hmap_node {
     struct hmap_node hmap_node;     /* hmap node */
     int vlan;                       /* VLAN */
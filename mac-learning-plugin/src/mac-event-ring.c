@@ -0,0 +1,114 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mac-event-ring.h"
+#include "util.h"
+
+struct mac_event_ring *
+mac_event_ring_create(unsigned int capacity)
+{
+    struct mac_event_ring *ring;
+    uint32_t i;
+
+    ring = xzalloc(sizeof *ring);
+    ring->mask = (1u << log_2_ceil(MAX(capacity, 2))) - 1;
+    ring->cells = xmalloc((ring->mask + 1) * sizeof *ring->cells);
+    for (i = 0; i <= ring->mask; i++) {
+        atomic_init(&ring->cells[i].seq, i);
+    }
+    atomic_init(&ring->head, 0);
+    ring->tail = 0;
+    atomic_init(&ring->n_dropped, 0);
+    return ring;
+}
+
+void
+mac_event_ring_destroy(struct mac_event_ring *ring)
+{
+    if (ring) {
+        free(ring->cells);
+        free(ring);
+    }
+}
+
+bool
+mac_event_ring_push(struct mac_event_ring *ring,
+                    const struct mlearn_event *event)
+{
+    struct mac_event_ring_cell *cell;
+    uint32_t pos, seq;
+    uint64_t orig;
+
+    atomic_read_relaxed(&ring->head, &pos);
+    for (;;) {
+        int32_t diff;
+
+        cell = &ring->cells[pos & ring->mask];
+        atomic_read_explicit(&cell->seq, &seq, memory_order_acquire);
+        diff = (int32_t) (seq - pos);
+        if (!diff) {
+            /* On failure 'pos' is updated to the current head. */
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The cell still holds the event of the previous lap. */
+            atomic_add_relaxed(&ring->n_dropped, 1, &orig);
+            return false;
+        } else {
+            atomic_read_relaxed(&ring->head, &pos);
+        }
+    }
+
+    cell->event = *event;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool
+mac_event_ring_pop(struct mac_event_ring *ring, struct mlearn_event *event)
+{
+    struct mac_event_ring_cell *cell = &ring->cells[ring->tail & ring->mask];
+    uint32_t seq;
+
+    atomic_read_explicit(&cell->seq, &seq, memory_order_acquire);
+    if (seq != ring->tail + 1) {
+        return false;
+    }
+
+    *event = cell->event;
+    atomic_store_explicit(&cell->seq, ring->tail + ring->mask + 1,
+                          memory_order_release);
+    ring->tail++;
+    return true;
+}
+
+unsigned int
+mac_event_ring_capacity(const struct mac_event_ring *ring)
+{
+    return ring->mask + 1;
+}
+
+uint64_t
+mac_event_ring_n_dropped(struct mac_event_ring *ring)
+{
+    uint64_t n_dropped;
+
+    atomic_read_relaxed(&ring->n_dropped, &n_dropped);
+    return n_dropped;
+}
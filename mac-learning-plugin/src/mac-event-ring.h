@@ -0,0 +1,67 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MAC_EVENT_RING_H
+#define MAC_EVENT_RING_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mac-learning-plugin.h"
+#include "ovs-atomic.h"
+
+/* MAC event ring.
+ *
+ * A bounded ring of MAC events with any number of producers, the SDK
+ * threads of the asic plugin, and a single consumer, the main thread.
+ * Neither side takes a lock: a producer claims a slot by advancing 'head'
+ * with a compare and swap, then publishes the event through the sequence
+ * number of the slot, which the consumer checks before reading it.
+ *
+ * When the ring is full the event is dropped and counted in 'n_dropped',
+ * which the consumer watches to resync the MAC table.
+ *
+ * mac_event_ring_create: returns a ring of 'capacity' events, rounded up to
+ * a power of 2.
+ *
+ * mac_event_ring_push: posts 'event' into 'ring'.  Returns false, and counts
+ * the drop, if it is full.  Thread safe.
+ *
+ * mac_event_ring_pop: takes the oldest event of 'ring' into 'event'.  Returns
+ * false if there is none published.  Only one thread may call it.
+ */
+
+struct mac_event_ring_cell {
+    atomic_uint32_t seq;            /* Position the cell is ready for. */
+    struct mlearn_event event;
+};
+
+struct mac_event_ring {
+    uint32_t mask;                  /* Capacity - 1. */
+    struct mac_event_ring_cell *cells;
+
+    atomic_uint32_t head;           /* Next position to claim. */
+    uint32_t tail;                  /* Next position to consume. */
+
+    atomic_uint64_t n_dropped;      /* Events dropped on a full ring. */
+};
+
+struct mac_event_ring *mac_event_ring_create(unsigned int capacity);
+void mac_event_ring_destroy(struct mac_event_ring *);
+bool mac_event_ring_push(struct mac_event_ring *, const struct mlearn_event *);
+bool mac_event_ring_pop(struct mac_event_ring *, struct mlearn_event *);
+unsigned int mac_event_ring_capacity(const struct mac_event_ring *);
+uint64_t mac_event_ring_n_dropped(struct mac_event_ring *);
+
+#endif /* mac-event-ring.h */
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include <sched.h>
 #include <stdio.h>
 #include <hash.h>
 #include <ovsdb-idl.h>
@@ -30,13 +31,15 @@
 #include "poll-loop.h"
 #include "bridge.h"
 #include "timeval.h"
+#include "txn-coalescer.h"
+#include "dynamic-string.h"
+#include "unixctl.h"
+#include "mac-event-ring.h"
 
 VLOG_DEFINE_THIS_MODULE(mac_learning);
 
 struct port;
 
-static struct ovsdb_idl_index_cursor cursor;
-
 /* OVSDB IDL used to obtain configuration. */
 static struct ovsdb_idl *idl = NULL;
 static unsigned int maclearn_idl_seqno;
@@ -44,23 +47,150 @@ static unsigned int maclearn_idl_seqno;
 /* MAC Flush Retry time in msec */
 #define MAC_FLUSH_RETRY_MSEC 1000
 
-static void mac_learning_update_db(void);
+/* Most MAC rows written per transaction. */
+#define MAC_LEARNING_TXN_MAX_ROWS 1000
+
+/* MAC flap dampening defaults: a MAC moving more than the threshold set in
+ * "mac-learning-flap-threshold" times within MAC_FLAP_DFLT_WINDOW msec is
+ * flapping, until it stays MAC_FLAP_DFLT_HOLD_DOWN msec without moving.  The
+ * threshold defaults to 0, which disables dampening. */
+#define MAC_FLAP_DFLT_THRESHOLD 0
+#define MAC_FLAP_DFLT_WINDOW    1000
+#define MAC_FLAP_DFLT_HOLD_DOWN 10000
+
+/* MAC table status key set to "true" while the MAC is flapping. */
+#define MAC_STATUS_FLAPPING "flapping"
+
+/* Size of the MAC event ring, in events. */
+#define MAC_EVENT_RING_DFLT_SIZE BUFFER_SIZE
+#define MAC_EVENT_RING_MIN_SIZE  1024
+#define MAC_EVENT_RING_MAX_SIZE  (1 << 20)
+
+static void mac_learning_update_db(struct ovsdb_idl_txn *mac_txn, void *aux);
+static void mac_learning_update_db_done(enum ovsdb_idl_txn_status status,
+                                        void *aux);
+static void mac_flush_update_db(struct ovsdb_idl_txn *txn, void *aux);
+static void mac_flush_update_db_done(enum ovsdb_idl_txn_status status,
+                                     void *aux);
 static void mlearn_plugin_db_add_local_mac_entry (
-                                  struct mlearn_hmap_node *mlearn_node,
-                                  struct ovsdb_idl_txn *mac_txn);
+                                  const struct mlearn_event *mlearn_event);
 static void mlearn_plugin_db_del_local_mac_entry (
-                                  struct mlearn_hmap_node *mlearn_node);
+                                  const struct mlearn_event *mlearn_event);
 struct asic_plugin_interface* get_plugin_asic_interface (void);
 static void mac_learning_table_monitor (struct blk_params *blk_params);
 static void mac_learning_wait_seq (void);
-static void mac_learning_reconfigure (void);
+static bool mac_learning_reconfigure (void);
 static void mac_flush_monitor(struct blk_params *blk_params);
+static unixctl_cb_func mac_learning_unixctl_flaps;
 
 static struct asic_plugin_interface *p_asic_plugin_interface = NULL;
+static int asic_plugin_minor;
 static uint64_t maclearn_seqno = LLONG_MIN;
 
+/* Ring of the MAC events posted by the asic plugin.  It is only replaced by
+ * the main thread, which frees the previous one once no producer can hold it
+ * any more.
+ *
+ * The producers are threads of the SDK that OVS RCU does not know about, so
+ * they are counted instead.  A producer counts itself in the 'ring_users'
+ * slot of the current 'ring_epoch' before it reads 'event_ring', and uncounts
+ * itself once it posted.  After storing a new ring, the main thread moves to
+ * the next epoch and waits for the slot of the previous one to drain, twice,
+ * so that both slots were seen empty after the store: a producer counted
+ * since then reads the new ring.  New producers go to the other slot, so the
+ * wait ends whatever the event rate. */
+static ATOMIC(struct mac_event_ring *) event_ring = ATOMIC_VAR_INIT(NULL);
+static atomic_uint ring_epoch = ATOMIC_VAR_INIT(0);
+static atomic_uint ring_users[2] = { ATOMIC_VAR_INIT(0), ATOMIC_VAR_INIT(0) };
+
+/* MAC event statistics, shown by "mac-learning/show". */
+static unsigned long long int n_events;     /* Events received. */
+static unsigned long long int n_writes;     /* MAC rows written. */
+static unsigned long long int n_dropped;    /* Events lost on a full ring. */
+static unsigned long long int n_resyncs;    /* MAC table resyncs. */
+static uint64_t ring_n_dropped;             /* Drops of 'event_ring' seen. */
+static bool resync_needed;
+
+/* MAC flap dampening settings, from the Open_vSwitch other_config column. */
+static int flap_threshold = MAC_FLAP_DFLT_THRESHOLD;  /* 0 to disable. */
+static int flap_window = MAC_FLAP_DFLT_WINDOW;
+static int flap_hold_down = MAC_FLAP_DFLT_HOLD_DOWN;
+
+/* MAC flap statistics. */
+static unsigned long long int n_flaps;      /* MACs found flapping. */
+static unsigned long long int n_moves_held; /* Moves not written. */
+
+/* Dynamic MAC entry of the MAC table.
+ *
+ * The plugin keeps the dynamic rows of the MAC table indexed by MAC address
+ * and VLAN, so that an event finds its row with a single hash lookup.  The
+ * entries follow the rows the plugin writes and, through the IDL change
+ * tracking of the MAC table, the rows other clients write. */
+struct mlearn_mac_entry {
+    struct hmap_node hmap_node;     /* In 'mac_entries'. */
+    struct hmap_node row_node;      /* In 'mac_entries_by_row', if 'row'. */
+    struct eth_addr mac;
+    int vlan;
+    char port_name[PORT_NAME_SIZE]; /* Port the MAC was last learned on. */
+    bool deleted;                   /* MAC aged out, delete the row. */
+
+    const struct ovsrec_mac *row;   /* NULL until the IDL has the row. */
+    bool inserting;                 /* Row insertion not committed yet. */
+    unsigned int insert_seqno;      /* 'mac_write_seqno' of the insertion. */
+    bool deleting;                  /* Row deletion not tracked yet. */
+    unsigned int delete_seqno;      /* 'mac_write_seqno' of the deletion. */
+
+    bool dirty;                     /* In 'dirty_mac_entries'. */
+    struct ovs_list dirty_node;
+
+    /* Flap dampening.  The moves are counted in windows of 'flap_window'
+     * msec, and the rate is estimated over the last 'flap_window' msec from
+     * the current and previous windows. */
+    long long int move_window;      /* Start of the current window. */
+    unsigned int n_moves;           /* Moves in the current window. */
+    unsigned int n_prev_moves;      /* Moves in the previous window. */
+    unsigned long long int n_flaps; /* Times the MAC was found flapping. */
+    bool flapping;                  /* In 'flapping_mac_entries'. */
+    long long int hold_until;       /* End of the hold-down, if flapping. */
+    struct ovs_list flap_node;
+};
+
+static struct hmap mac_entries = HMAP_INITIALIZER(&mac_entries);
+static struct hmap mac_entries_by_row = HMAP_INITIALIZER(&mac_entries_by_row);
+
+/* Entries to write once their inserted row showed up, or once the
+ * transaction that inserted it failed. */
+static struct ovs_list dirty_mac_entries
+    = OVS_LIST_INITIALIZER(&dirty_mac_entries);
+
+/* Entries whose moves are not written until their hold-down ends. */
+static struct ovs_list flapping_mac_entries
+    = OVS_LIST_INITIALIZER(&flapping_mac_entries);
+
+/* Writes of 'mac_learning_writer' so far, and writes completed so far. */
+static unsigned int mac_write_seqno;
+static unsigned int mac_done_seqno;
+
 static struct seq *mlearn_trigger_seq = NULL;
 
+/* The MAC table is written in the transaction coalesced at the end of the
+ * main loop iteration.  The flush requests are cleared in a transaction of
+ * their own, since a conflict on the columns they verify must not fail the
+ * writes of the other modules. */
+static struct txn_writer mac_learning_writer =
+    TXN_WRITER_INITIALIZER("mac-learning", mac_learning_update_db,
+                           mac_learning_update_db_done, NULL);
+static struct txn_writer mac_flush_writer =
+    TXN_WRITER_ISOLATED_INITIALIZER("mac-flush", mac_flush_update_db,
+                                    mac_flush_update_db_done, NULL);
+
+/* Port and VLAN rows whose flush requests are cleared by the next
+ * 'mac_flush_writer' write. */
+static const struct ovsrec_port **flushed_ports = NULL;
+static size_t n_flushed_ports, allocated_flushed_ports;
+static const struct ovsrec_vlan **flushed_vlans = NULL;
+static size_t n_flushed_vlans, allocated_flushed_vlans;
+
 struct asic_plugin_interface *
 get_plugin_asic_interface (void)
 {
@@ -71,11 +201,11 @@ get_plugin_asic_interface (void)
     }
 
     if (!find_plugin_extension(ASIC_PLUGIN_INTERFACE_NAME,
-                               ASIC_PLUGIN_INTERFACE_MAJOR,
-                               ASIC_PLUGIN_INTERFACE_MINOR,
+                               ASIC_PLUGIN_INTERFACE_MAJOR, 0,
                                &p_extension)) {
         if (p_extension) {
             p_asic_plugin_interface = p_extension->plugin_interface;
+            asic_plugin_minor = p_extension->minor;
             return (p_extension->plugin_interface);
         }
     }
@@ -109,6 +239,109 @@ mac_learning_trigger_callback(void)
     seq_change(mac_learning_trigger_seq_get());
 }
 
+/*
+ * Function: mac_learning_event_post
+ *
+ * Posts a MAC event of the asic plugin, from any thread.
+ */
+static bool
+mac_learning_event_post(const struct mlearn_event *event)
+{
+    struct mac_event_ring *ring;
+    unsigned int epoch, orig;
+    bool posted;
+
+    /* Be counted before reading the ring, so that it is not freed under us,
+     * see 'event_ring'. */
+    atomic_read(&ring_epoch, &epoch);
+    atomic_add(&ring_users[epoch & 1], 1, &orig);
+    atomic_read(&event_ring, &ring);
+
+    posted = mac_event_ring_push(ring, event);
+    atomic_sub(&ring_users[epoch & 1], 1, &orig);
+    return posted;
+}
+
+/* Waits until no producer can still hold a ring replaced before the call. */
+static void
+mac_learning_event_ring_sync(void)
+{
+    unsigned int epoch, users;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        atomic_add(&ring_epoch, 1, &epoch);
+        for (;;) {
+            atomic_read(&ring_users[epoch & 1], &users);
+            if (!users) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+}
+
+/*
+ * Function: mac_learning_event_ring_check
+ *
+ * Accounts the events 'ring' dropped since the last check, and requests a
+ * resync of the MAC table if there are any.
+ */
+static void
+mac_learning_event_ring_check(struct mac_event_ring *ring)
+{
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    uint64_t dropped = mac_event_ring_n_dropped(ring);
+
+    if (dropped != ring_n_dropped) {
+        VLOG_WARN_RL(&rl, "MAC event ring full, %"PRIu64" events lost, "
+                     "resyncing the MAC table", dropped - ring_n_dropped);
+        n_dropped += dropped - ring_n_dropped;
+        ring_n_dropped = dropped;
+        resync_needed = true;
+    }
+}
+
+/*
+ * Function: mac_learning_event_ring_set_size
+ *
+ * Replaces the MAC event ring by one of 'size' events, if that changes its
+ * capacity.  Pending events move to the new ring.
+ */
+static void
+mac_learning_event_ring_set_size(int size)
+{
+    struct mac_event_ring *old, *new;
+    struct mlearn_event event;
+
+    size = MIN(MAX(size, MAC_EVENT_RING_MIN_SIZE), MAC_EVENT_RING_MAX_SIZE);
+    atomic_read(&event_ring, &old);
+    if (old && mac_event_ring_capacity(old) == 1u << log_2_ceil(size)) {
+        return;
+    }
+
+    new = mac_event_ring_create(size);
+    atomic_store(&event_ring, new);
+    if (!old) {
+        return;
+    }
+
+    /* Producers that got the old ring are done within a few instructions,
+     * and the later ones find the new ring. */
+    mac_learning_event_ring_sync();
+
+    mac_learning_event_ring_check(old);
+    while (mac_event_ring_pop(old, &event)) {
+        mac_event_ring_push(new, &event);
+    }
+    ring_n_dropped = 0;
+    mac_learning_event_ring_check(new);
+    mac_event_ring_destroy(old);
+
+    VLOG_INFO("MAC event ring resized to %u events",
+              mac_event_ring_capacity(new));
+}
+
 /*
  * mac_learning_plugin
  *
@@ -117,6 +350,39 @@ mac_learning_trigger_callback(void)
  */
 static struct mac_learning_plugin_interface mac_learning_plugin = {
     .mac_learning_trigger_callback = &mac_learning_trigger_callback,
+    .mac_learning_event_post = &mac_learning_event_post,
+};
+
+static void
+mac_learning_unixctl_show(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                          const char *argv[] OVS_UNUSED,
+                          void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    struct mac_event_ring *ring;
+
+    atomic_read(&event_ring, &ring);
+    ds_put_format(&ds, "MAC event ring size: %u\n",
+                  mac_event_ring_capacity(ring));
+    ds_put_format(&ds, "MAC events received: %llu\n", n_events);
+    ds_put_format(&ds, "MAC rows written: %llu\n", n_writes);
+    ds_put_format(&ds, "MAC rows to write: %"PRIuSIZE"\n",
+                  list_size(&dirty_mac_entries));
+    ds_put_format(&ds, "MAC events lost: %llu\n", n_dropped);
+    ds_put_format(&ds, "MAC table resyncs: %llu\n", n_resyncs);
+    ds_put_format(&ds, "MAC flaps: %llu\n", n_flaps);
+    ds_put_format(&ds, "MAC flapping: %"PRIuSIZE"\n",
+                  list_size(&flapping_mac_entries));
+    ds_put_format(&ds, "MAC moves held: %llu\n", n_moves_held);
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+/* mac_flush_monitor only looks for deleted VLANs and ports. */
+static const struct reconfigure_interest mac_flush_interests[] = {
+    { &ovsrec_table_vlan, NULL },
+    { &ovsrec_table_port, NULL },
 };
 
 static struct plugin_extension_interface mac_learning_extension = {
@@ -135,7 +401,12 @@ static struct plugin_extension_interface mac_learning_extension = {
 void init (int phase_id)
 {
     VLOG_DBG("in mac learning plugin init, phase_id: %d", phase_id);
+    mac_learning_event_ring_set_size(MAC_EVENT_RING_DFLT_SIZE);
     register_plugin_extension(&mac_learning_extension);
+    unixctl_command_register("mac-learning/show", "", 0, 0,
+                             mac_learning_unixctl_show, NULL);
+    unixctl_command_register("mac-learning/flaps", "", 0, 0,
+                             mac_learning_unixctl_flaps, NULL);
 
     VLOG_INFO("in mac learning plugin init, registering BLK_BRIDGE_INIT");
 
@@ -144,9 +415,9 @@ void init (int phase_id)
                                   NO_PRIORITY);
 
     /* register_callback for port del */
-    register_reconfigure_callback(&mac_flush_monitor,
-                                  BLK_BR_DELETE_PORTS,
-                                  NO_PRIORITY);
+    register_reconfigure_callback_with_interest(
+        &mac_flush_monitor, BLK_BR_DELETE_PORTS, NO_PRIORITY,
+        mac_flush_interests, ARRAY_SIZE(mac_flush_interests));
 }
 
 /*
@@ -158,9 +429,6 @@ void init (int phase_id)
  */
 static void mac_learning_table_monitor (struct blk_params *blk_params)
 {
-    struct ovsdb_idl_index *index = NULL;
-    bool cursor_initialized = false;
-
     /*
      * MAC table related
      */
@@ -177,19 +445,11 @@ static void mac_learning_table_monitor (struct blk_params *blk_params)
         return;
     }
 
-    /* Initialize Compound Indexes */
-    index = ovsdb_idl_create_index(idl, &ovsrec_table_mac, "by_macFrom");
-    ovs_assert(index);
-
-    /* add indexing columns */
-    ovsdb_idl_index_add_column(index, &ovsrec_mac_col_mac_addr,
-                               OVSDB_INDEX_ASC, ovsrec_mac_index_mac_addr_cmp);
-    ovsdb_idl_index_add_column(index, &ovsrec_mac_col_from,
-                               OVSDB_INDEX_ASC, ovsrec_mac_index_from_cmp);
-
-    cursor_initialized = ovsdb_idl_initialize_cursor(idl, &ovsrec_table_mac,
-                                                     "by_macFrom", &cursor);
-    ovs_assert(cursor_initialized == true);
+    /* The MAC entries follow the rows inserted and deleted. */
+    ovsdb_idl_track_add_column(idl, &ovsrec_mac_col_mac_addr);
+    ovsdb_idl_track_add_column(idl, &ovsrec_mac_col_from);
+    ovsdb_idl_track_add_column(idl, &ovsrec_mac_col_mac_vlan);
+    ovsdb_idl_track_add_column(idl, &ovsrec_mac_col_port);
 } /* mac_learning_table_monitor */
 
 /*
@@ -198,141 +458,633 @@ static void mac_learning_table_monitor (struct blk_params *blk_params)
  * This function is called from plugins_run -> run
  *
  * This function checks if the sequence number is changed or not
- * If yes, it changes the MAC table for the new update.
+ * If yes, it returns true for the MAC events to be read.
  */
-static void mac_learning_reconfigure (void)
+static bool mac_learning_reconfigure (void)
 {
     uint64_t seq = seq_read(mac_learning_trigger_seq_get());
 
     if (seq != maclearn_seqno) {
         maclearn_seqno = seq;
-        mac_learning_update_db();
+        return true;
     }
+    return false;
+}
+
+/* Returns the hash of the MAC entry of 'mac' on 'vlan'. */
+static uint32_t
+mlearn_mac_hash(const struct eth_addr *mac, int vlan)
+{
+    return hash_bytes(mac, sizeof *mac, vlan);
+}
+
+static struct mlearn_mac_entry *
+mlearn_mac_find(const struct eth_addr *mac, int vlan)
+{
+    struct mlearn_mac_entry *entry;
+
+    HMAP_FOR_EACH_WITH_HASH (entry, hmap_node, mlearn_mac_hash(mac, vlan),
+                             &mac_entries) {
+        if (eth_addr_equals(entry->mac, *mac) && entry->vlan == vlan) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static struct mlearn_mac_entry *
+mlearn_mac_find_by_row(const struct ovsrec_mac *row)
+{
+    struct mlearn_mac_entry *entry;
+
+    HMAP_FOR_EACH_WITH_HASH (entry, row_node, uuid_hash(&row->header_.uuid),
+                             &mac_entries_by_row) {
+        if (entry->row == row) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static struct mlearn_mac_entry *
+mlearn_mac_create(const struct eth_addr *mac, int vlan)
+{
+    struct mlearn_mac_entry *entry;
+
+    entry = xzalloc(sizeof *entry);
+    entry->mac = *mac;
+    entry->vlan = vlan;
+    hmap_insert(&mac_entries, &entry->hmap_node, mlearn_mac_hash(mac, vlan));
+    return entry;
+}
+
+static void
+mlearn_mac_set_row(struct mlearn_mac_entry *entry,
+                   const struct ovsrec_mac *row)
+{
+    if (entry->row) {
+        hmap_remove(&mac_entries_by_row, &entry->row_node);
+    }
+    entry->row = row;
+    if (row) {
+        hmap_insert(&mac_entries_by_row, &entry->row_node,
+                    uuid_hash(&row->header_.uuid));
+    }
+}
+
+static void
+mlearn_mac_destroy(struct mlearn_mac_entry *entry)
+{
+    mlearn_mac_set_row(entry, NULL);
+    if (entry->dirty) {
+        list_remove(&entry->dirty_node);
+    }
+    if (entry->flapping) {
+        list_remove(&entry->flap_node);
+    }
+    hmap_remove(&mac_entries, &entry->hmap_node);
+    free(entry);
+}
+
+/* Makes 'entry' be written by one of the next 'mac_learning_writer' writes.
+ * However many events it gets meanwhile, only its last state is written. */
+static void
+mlearn_mac_set_dirty(struct mlearn_mac_entry *entry)
+{
+    if (!entry->dirty) {
+        entry->dirty = true;
+        list_push_back(&dirty_mac_entries, &entry->dirty_node);
+    }
+}
+
+/* Requests a write of the dirty entries, unless the previous one is still
+ * in flight: the next one is requested once it completes. */
+static void
+mlearn_mac_request_write(void)
+{
+    if (!list_is_empty(&dirty_mac_entries)
+        && !txn_writer_is_busy(&mac_learning_writer)) {
+        txn_writer_request(&mac_learning_writer);
+    }
+}
+
+static bool
+mlearn_mac_row_is_flapping(const struct ovsrec_mac *row)
+{
+    return smap_get_bool(&row->status, MAC_STATUS_FLAPPING, false);
+}
+
+static void
+mlearn_mac_row_set_flapping(const struct ovsrec_mac *row, bool flapping)
+{
+    struct smap status;
+
+    smap_clone(&status, &row->status);
+    if (flapping) {
+        smap_replace(&status, MAC_STATUS_FLAPPING, "true");
+    } else {
+        smap_remove(&status, MAC_STATUS_FLAPPING);
+    }
+    ovsrec_mac_set_status(row, &status);
+    smap_destroy(&status);
+}
+
+/* Returns true if the row of 'entry' differs from what must be written to
+ * it.  The port of a flapping MAC is held until its hold-down ends. */
+static bool
+mlearn_mac_row_is_stale(const struct mlearn_mac_entry *entry)
+{
+    const struct ovsrec_mac *row = entry->row;
+
+    return (entry->deleted
+            || mlearn_mac_row_is_flapping(row) != entry->flapping
+            || (!entry->flapping
+                && (!row->port || strcmp(row->port->name, entry->port_name))));
 }
 
 /*
- * Function: mlearn_plugin_db_add_local_mac_entry
+ * Function: mlearn_mac_sync
  *
- * This function takes the hmap node and inserts/updates the corresponding entry
- * of MAC table in OVSDB.
+ * Writes, within 'mac_txn', the MAC table row of 'entry' according to the
+ * last event for its MAC address and VLAN: inserts the row, points it to the
+ * port the MAC was learned on or deletes it.  A row inserted by a previous
+ * write and not yet in the IDL is written once it shows up.
  */
 static void
-mlearn_plugin_db_add_local_mac_entry (
-                                  struct mlearn_hmap_node *mlearn_node,
-                                  struct ovsdb_idl_txn *mac_txn)
+mlearn_mac_sync(struct mlearn_mac_entry *entry, struct ovsdb_idl_txn *mac_txn)
 {
     const struct ovsrec_mac *mac_e = NULL;
     struct bridge *br = NULL;
     struct port *port = NULL;
-    struct ovsrec_mac mac_val;
     char str[18];
-    bool found = false;
 
-    if (mlearn_node == NULL) {
-        VLOG_ERR("%s: mlearn_node is null", __FUNCTION__);
+    /* The entry is kept until the deletion of its row is tracked, so that
+     * a MAC learned again meanwhile does not get a second row, and a failed
+     * deletion is written again. */
+    if (entry->deleting) {
         return;
     }
 
-    br = get_bridge_from_port_name(mlearn_node->port_name, &port);
+    if (entry->deleted) {
+        if (entry->row) {
+            ovsrec_mac_delete(entry->row);
+            entry->deleting = true;
+            entry->delete_seqno = mac_write_seqno;
+        } else if (!entry->inserting) {
+            mlearn_mac_destroy(entry);
+        }
+        return;
+    }
+
+    if (!entry->row && entry->inserting) {
+        return;
+    }
 
+    br = get_bridge_from_port_name(entry->port_name, &port);
     if (!port) {
         VLOG_DBG("%s: port not found %s "ETH_ADDR_FMT, __FUNCTION__,
-                 mlearn_node->port_name, ETH_ADDR_ARGS(mlearn_node->mac));
+                 entry->port_name, ETH_ADDR_ARGS(entry->mac));
+        if (!entry->row) {
+            mlearn_mac_destroy(entry);
+        }
         return;
     }
 
-    memset(str, 0, sizeof(str));
-    sprintf(str, ETH_ADDR_FMT, ETH_ADDR_ARGS(mlearn_node->mac));
+    if (entry->row) {
+        if (mlearn_mac_row_is_flapping(entry->row) != entry->flapping) {
+            mlearn_mac_row_set_flapping(entry->row, entry->flapping);
+        }
+        /* MAC entry found and update the move state.  The port of a
+         * flapping MAC is written by mlearn_mac_flap_run() once its
+         * hold-down ends. */
+        if (!entry->flapping && entry->row->port != port->cfg) {
+            ovsrec_mac_set_bridge(entry->row, br->cfg);
+            ovsrec_mac_set_port(entry->row, port->cfg);
+            VLOG_DBG("%s: "ETH_ADDR_FMT" update vlan: %d, bridge: %s, "
+                     "port: %s, from: %s", __FUNCTION__,
+                     ETH_ADDR_ARGS(entry->mac), entry->vlan, br->name,
+                     port->name, OVSREC_MAC_FROM_DYNAMIC);
+        }
+        return;
+    }
+
+    /* MAC Entry not found, consider as new entry */
+    snprintf(str, sizeof str, ETH_ADDR_FMT, ETH_ADDR_ARGS(entry->mac));
+    mac_e = ovsrec_mac_insert(mac_txn);
+    ovsrec_mac_set_bridge(mac_e, br->cfg);
+    ovsrec_mac_set_from(mac_e, OVSREC_MAC_FROM_DYNAMIC);
+    ovsrec_mac_set_mac_addr(mac_e, str);
+    ovsrec_mac_set_port(mac_e, port->cfg);
+    ops_mac_set_vlan(entry->vlan, mac_e, idl);
+    if (entry->flapping) {
+        mlearn_mac_row_set_flapping(mac_e, true);
+    }
+    entry->inserting = true;
+    entry->insert_seqno = mac_write_seqno;
+    VLOG_DBG("%s: %s: insert vlan: %d, bridge: %s, port: %s, from: %s",
+              __FUNCTION__, str, entry->vlan, br->name, port->name,
+              OVSREC_MAC_FROM_DYNAMIC);
+}
+
+/* Returns the moves of 'entry' over the last 'flap_window' msec. */
+static unsigned int
+mlearn_mac_move_rate(struct mlearn_mac_entry *entry, long long int now)
+{
+    long long int elapsed = now - entry->move_window;
+
+    if (elapsed >= 2 * flap_window) {
+        entry->n_prev_moves = 0;
+        entry->n_moves = 0;
+        entry->move_window = now;
+        elapsed = 0;
+    } else if (elapsed >= flap_window) {
+        entry->n_prev_moves = entry->n_moves;
+        entry->n_moves = 0;
+        entry->move_window += flap_window;
+        elapsed -= flap_window;
+    }
+    return entry->n_moves + (entry->n_prev_moves * (flap_window - elapsed)
+                             / flap_window);
+}
+
+/*
+ * Function: mlearn_mac_flap_check
+ *
+ * Accounts a move of 'entry'.  Returns true if the move must not be written
+ * because the MAC is flapping: it moved more than 'flap_threshold' times
+ * within 'flap_window' msec, and kept moving since less than
+ * 'flap_hold_down' msec.  The MAC is flagged in the MAC table once it starts
+ * flapping, and its last port is written once its hold-down ends.
+ */
+static bool
+mlearn_mac_flap_check(struct mlearn_mac_entry *entry)
+{
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    long long int now = time_msec();
+
+    if (!flap_threshold) {
+        return false;
+    }
+
+    entry->n_moves++;
+    if (entry->flapping) {
+        entry->hold_until = now + flap_hold_down;
+        return true;
+    }
+    if (mlearn_mac_move_rate(entry, now) <= flap_threshold) {
+        return false;
+    }
 
-    /* initialize the indexes with values to be compared  */
-    memset(&mac_val, 0, sizeof(mac_val));
-    mac_val.mac_addr = str;
-    mac_val.from = OVSREC_MAC_FROM_DYNAMIC;
+    VLOG_WARN_RL(&rl, "MAC "ETH_ADDR_FMT" vlan %d is flapping, last on port "
+                 "%s, holding its moves", ETH_ADDR_ARGS(entry->mac),
+                 entry->vlan, entry->port_name);
+    entry->flapping = true;
+    entry->hold_until = now + flap_hold_down;
+    entry->n_flaps++;
+    n_flaps++;
+    list_push_back(&flapping_mac_entries, &entry->flap_node);
+
+    /* Write the flag.  The port stays the one written last. */
+    return false;
+}
 
-    OVSREC_MAC_FOR_EACH_EQUAL (mac_e, &cursor, &mac_val) {
-        /* MAC entry found and update the move state*/
-        if ( mac_e->mac_vlan && mlearn_node->vlan == mac_e->mac_vlan->id) {
-            ovsrec_mac_set_bridge(mac_e, br->cfg);
-            ovsrec_mac_set_port(mac_e, port->cfg);
-            found = true;
-            VLOG_DBG("%s: MAC:%s update vlan: %d, bridge: %s, port: %s, from: %s",
-                     __FUNCTION__, str, mlearn_node->vlan, br->name, port->name,
-                     OVSREC_MAC_FROM_DYNAMIC);
+/*
+ * Function: mlearn_mac_flap_run
+ *
+ * Ends the hold-down of the flapping MACs that stopped moving, so that their
+ * last port is written and their flag cleared.
+ */
+static void
+mlearn_mac_flap_run(void)
+{
+    struct mlearn_mac_entry *entry, *next;
+    long long int now = time_msec();
+
+    LIST_FOR_EACH_SAFE (entry, next, flap_node, &flapping_mac_entries) {
+        if (now >= entry->hold_until || !flap_threshold) {
+            VLOG_INFO("MAC "ETH_ADDR_FMT" vlan %d stopped flapping, on port "
+                      "%s", ETH_ADDR_ARGS(entry->mac), entry->vlan,
+                      entry->port_name);
+            list_remove(&entry->flap_node);
+            entry->flapping = false;
+
+            /* mlearn_mac_sync() writes the last port and clears the flag. */
+            mlearn_mac_set_dirty(entry);
         }
     }
+}
 
-    /* MAC Entry not found, consider as new entry */
-    if (!found) {
-        mac_e = ovsrec_mac_insert(mac_txn);
-        ovsrec_mac_set_bridge(mac_e, br->cfg);
-        ovsrec_mac_set_from(mac_e, OVSREC_MAC_FROM_DYNAMIC);
-        ovsrec_mac_set_mac_addr(mac_e, str);
-        ovsrec_mac_set_port(mac_e, port->cfg);
-        ops_mac_set_vlan(mlearn_node->vlan, mac_e, idl);
-        VLOG_DBG("%s: %s: insert vlan: %d, bridge: %s, port: %s, from: %s",
-                  __FUNCTION__, str, mlearn_node->vlan, br->name, port->name,
-                  OVSREC_MAC_FROM_DYNAMIC);
+static void
+mlearn_mac_flap_wait(void)
+{
+    struct mlearn_mac_entry *entry;
+
+    LIST_FOR_EACH (entry, flap_node, &flapping_mac_entries) {
+        poll_timer_wait_until(entry->hold_until);
+    }
+}
+
+static void
+mac_learning_unixctl_flaps(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                           const char *argv[] OVS_UNUSED,
+                           void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    struct mlearn_mac_entry *entry;
+    long long int now = time_msec();
+
+    ds_put_format(&ds, "flap threshold: %d moves in %d ms, hold-down: %d ms\n",
+                  flap_threshold, flap_window, flap_hold_down);
+    ds_put_format(&ds, "%-17s %-6s %-16s %-8s %-8s %s\n", "MAC", "VLAN",
+                  "port", "moves", "flaps", "held(ms)");
+    HMAP_FOR_EACH (entry, hmap_node, &mac_entries) {
+        if (!entry->n_flaps) {
+            continue;
+        }
+        ds_put_format(&ds, ETH_ADDR_FMT" %-6d %-16s %-8u %-8llu %lld\n",
+                      ETH_ADDR_ARGS(entry->mac), entry->vlan,
+                      entry->port_name, mlearn_mac_move_rate(entry, now),
+                      entry->n_flaps,
+                      entry->flapping ? entry->hold_until - now : 0);
     }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
 }
 
 /*
- * Function: mlearn_plugin_db_del_local_mac_entry
+ * Function: mlearn_plugin_db_add_local_mac_entry
  *
- * This function takes the hmap node and deletes the corresponding entry
- * of MAC table in OVSDB.
+ * This function takes the MAC event and schedules the insertion/update of
+ * the corresponding entry of MAC table in OVSDB.
  */
 static void
-mlearn_plugin_db_del_local_mac_entry (struct mlearn_hmap_node *mlearn_node)
+mlearn_plugin_db_add_local_mac_entry (const struct mlearn_event *mlearn_node)
 {
-    const struct ovsrec_mac *mac_e = NULL;
-    struct ovsrec_mac mac_val;
-    char str[18] = {0};
+    struct mlearn_mac_entry *entry;
+    bool moved;
 
-    if (mlearn_node == NULL) {
-        VLOG_ERR("%s: mlearn_node is null", __FUNCTION__);
+    entry = mlearn_mac_find(&mlearn_node->mac, mlearn_node->vlan);
+    if (!entry) {
+        entry = mlearn_mac_create(&mlearn_node->mac, mlearn_node->vlan);
+    }
+    moved = (!entry->deleted && entry->port_name[0]
+             && strncmp(entry->port_name, mlearn_node->port_name,
+                        sizeof entry->port_name));
+    entry->deleted = false;
+    ovs_strlcpy(entry->port_name, mlearn_node->port_name,
+                sizeof entry->port_name);
+
+    if (moved && mlearn_mac_flap_check(entry)) {
+        n_moves_held++;
         return;
     }
-    snprintf(str, sizeof(str), ETH_ADDR_FMT,
-                                ETH_ADDR_ARGS(mlearn_node->mac));
+    mlearn_mac_set_dirty(entry);
+}
 
-    VLOG_DBG("%s: deleting mac: %s, vlan: %id, from: %s",
-             __FUNCTION__, str, mlearn_node->vlan, OVSREC_MAC_FROM_DYNAMIC);
+/*
+ * Function: mlearn_plugin_db_del_local_mac_entry
+ *
+ * This function takes the MAC event and schedules the deletion of the
+ * corresponding entry of MAC table in OVSDB.
+ */
+static void
+mlearn_plugin_db_del_local_mac_entry (const struct mlearn_event *mlearn_node)
+{
+    struct mlearn_mac_entry *entry;
+
+    entry = mlearn_mac_find(&mlearn_node->mac, mlearn_node->vlan);
+    if (entry) {
+        VLOG_DBG("%s: deleting mac: "ETH_ADDR_FMT", vlan: %d, from: %s",
+                 __FUNCTION__, ETH_ADDR_ARGS(mlearn_node->mac),
+                 mlearn_node->vlan, OVSREC_MAC_FROM_DYNAMIC);
+        entry->deleted = true;
+        mlearn_mac_set_dirty(entry);
+    }
+}
 
-    memset(&mac_val, 0, sizeof(mac_val));
+/*
+ * Function: mlearn_mac_track
+ *
+ * Follows the changes of the MAC table rows in the IDL: the rows inserted
+ * by the plugin once their insertion commits, and the dynamic rows that other
+ * clients, or a previous instance of switchd, inserted or deleted.
+ */
+static void
+mlearn_mac_track(void)
+{
+    const struct ovsrec_mac *mac_e;
+    struct mlearn_mac_entry *entry;
 
-    /* initialize the indexes with values to be comapred  */
-    mac_val.mac_addr = str;
-    mac_val.from = OVSREC_MAC_FROM_DYNAMIC;
+    OVSREC_MAC_FOR_EACH_TRACKED (mac_e, idl) {
+        struct eth_addr mac;
 
-    OVSREC_MAC_FOR_EACH_EQUAL (mac_e, &cursor, &mac_val) {
-        /* mac row found and if it match same vlan, now delete */
-        if ( mac_e->mac_vlan && mlearn_node->vlan == mac_e->mac_vlan->id) {
-            ovsrec_mac_delete(mac_e);
+        if (ovsrec_mac_row_get_seqno(mac_e, OVSDB_IDL_CHANGE_DELETE)) {
+            entry = mlearn_mac_find_by_row(mac_e);
+            if (!entry) {
+                continue;
+            }
+            if (entry->deleting && !entry->deleted) {
+                /* Learned again while its row was being deleted. */
+                entry->deleting = false;
+                mlearn_mac_set_row(entry, NULL);
+                mlearn_mac_set_dirty(entry);
+            } else {
+                mlearn_mac_destroy(entry);
+            }
+            continue;
+        }
+
+        if (!ovsrec_mac_row_get_seqno(mac_e, OVSDB_IDL_CHANGE_INSERT)
+            || !mac_e->from || strcmp(mac_e->from, OVSREC_MAC_FROM_DYNAMIC)
+            || !mac_e->mac_vlan
+            || !ovs_scan(mac_e->mac_addr, ETH_ADDR_SCAN_FMT,
+                         ETH_ADDR_SCAN_ARGS(mac))) {
+            continue;
+        }
+
+        entry = mlearn_mac_find(&mac, mac_e->mac_vlan->id);
+        if (!entry) {
+            entry = mlearn_mac_create(&mac, mac_e->mac_vlan->id);
+            if (mac_e->port) {
+                ovs_strlcpy(entry->port_name, mac_e->port->name,
+                            sizeof entry->port_name);
+            }
+            mlearn_mac_set_row(entry, mac_e);
+            if (mlearn_mac_row_is_flapping(mac_e)) {
+                /* Left over by a previous switchd. */
+                mlearn_mac_set_dirty(entry);
+            }
+        } else if (!entry->row) {
+            /* Our insertion committed.  Write what happened since. */
+            entry->inserting = false;
+            mlearn_mac_set_row(entry, mac_e);
+            if (mlearn_mac_row_is_stale(entry)) {
+                mlearn_mac_set_dirty(entry);
+            }
+        } else if (entry->row != mac_e) {
+            VLOG_DBG("%s: "ETH_ADDR_FMT" vlan %d has more than one row",
+                     __FUNCTION__, ETH_ADDR_ARGS(mac), entry->vlan);
         }
     }
+
+    /* The tracked rows of every table are cleared by switchd once all its
+     * modules and plugins ran, see bridge_idl_track_clear(). */
 }
 
 /*
- * Function: mac_learning_update_db
+ * Function: mac_learning_apply_event
  *
- * This function is invoked in bridge_run, it checks if the sequence number
- * for MAC learning has changed or not. If changed, it correspondingly calls
- * function to get the hmap populated during MAC learning.
+ * Adds, moves or deletes the MAC entry of 'event'.
+ */
+static void
+mac_learning_apply_event(const struct mlearn_event *event)
+{
+    if (event->oper == MLEARN_ADD || event->oper == MLEARN_MOVE) {
+        /* add/move learnt mac to MAC table */
+        mlearn_plugin_db_add_local_mac_entry(event);
+    } else {
+        /* delete mac from the MAC table */
+        mlearn_plugin_db_del_local_mac_entry(event);
+    }
+    n_events++;
+}
+
+/* MAC address of the L2 table, while resyncing the MAC table. */
+struct mac_resync_entry {
+    struct hmap_node hmap_node;     /* In the resync table. */
+    struct mlearn_event event;
+};
+
+static void
+mac_resync_add(const struct mlearn_event *event, void *table_)
+{
+    struct hmap *table = table_;
+    struct mac_resync_entry *entry;
+
+    entry = xmalloc(sizeof *entry);
+    entry->event = *event;
+    hmap_insert(table, &entry->hmap_node,
+                mlearn_mac_hash(&event->mac, event->vlan));
+}
+
+static bool
+mac_resync_contains(const struct hmap *table, const struct eth_addr *mac,
+                    int vlan)
+{
+    const struct mac_resync_entry *entry;
+
+    HMAP_FOR_EACH_WITH_HASH (entry, hmap_node, mlearn_mac_hash(mac, vlan),
+                             table) {
+        if (eth_addr_equals(entry->event.mac, *mac)
+            && entry->event.vlan == vlan) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Function: mac_learning_resync
+ *
+ * Rewrites the dynamic entries of the MAC table from the L2 table of the
+ * asic plugin, after MAC events were lost.
+ */
+static void
+mac_learning_resync(void)
+{
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    struct asic_plugin_interface *p_asic_interface;
+    struct mlearn_mac_entry *mac_entry, *next_mac_entry;
+    struct mac_resync_entry *entry, *next_entry;
+    struct mac_event_ring *ring;
+    struct mlearn_event event;
+    struct hmap table;
+    int rc;
+
+    resync_needed = false;
+
+    p_asic_interface = get_plugin_asic_interface();
+    if (!p_asic_interface
+        || asic_plugin_minor < ASIC_PLUGIN_L2_ADDR_WALK_MINOR
+        || !p_asic_interface->l2_addr_walk) {
+        VLOG_WARN_RL(&rl, "%s: asic plugin cannot walk the L2 table, MAC "
+                     "table left as is", __FUNCTION__);
+        return;
+    }
+
+    /* The L2 table supersedes the events still queued. */
+    atomic_read(&event_ring, &ring);
+    while (mac_event_ring_pop(ring, &event)) {
+        continue;
+    }
+
+    hmap_init(&table);
+    rc = p_asic_interface->l2_addr_walk(mac_resync_add, &table);
+    if (rc) {
+        VLOG_ERR("%s: L2 table walk failed, rc %d", __FUNCTION__, rc);
+    } else {
+        HMAP_FOR_EACH_SAFE (mac_entry, next_mac_entry, hmap_node,
+                            &mac_entries) {
+            if (!mac_resync_contains(&table, &mac_entry->mac,
+                                     mac_entry->vlan)) {
+                mac_entry->deleted = true;
+                mlearn_mac_set_dirty(mac_entry);
+            }
+        }
+        HMAP_FOR_EACH (entry, hmap_node, &table) {
+            mac_learning_apply_event(&entry->event);
+        }
+        n_resyncs++;
+        VLOG_INFO("MAC table resynced from %"PRIuSIZE" L2 entries",
+                  hmap_count(&table));
+    }
+
+    HMAP_FOR_EACH_SAFE (entry, next_entry, hmap_node, &table) {
+        hmap_remove(&table, &entry->hmap_node);
+        free(entry);
+    }
+    hmap_destroy(&table);
+}
+
+static void
+mlearn_event_from_hmap_node(struct mlearn_event *event,
+                            const struct mlearn_hmap_node *mlearn_node)
+{
+    memset(event, 0, sizeof *event);
+    event->mac = mlearn_node->mac;
+    event->vlan = mlearn_node->vlan;
+    event->oper = mlearn_node->oper;
+    event->hw_unit = mlearn_node->hw_unit;
+    event->port = mlearn_node->port;
+    ovs_strlcpy(event->port_name, mlearn_node->port_name,
+                sizeof event->port_name);
+}
+
+/*
+ * Function: mac_learning_read_events
  *
- * It creates, removes entries in MAC table depending on the operation.
+ * Drains the MAC events posted by the asic plugin and, if 'triggered', gets
+ * the hmap populated during MAC learning from the asic plugins that do not
+ * post events.  The events only update the MAC entries: an entry that gets
+ * several of them before it is written is written once, in its last state.
  */
 static void
-mac_learning_update_db(void)
+mac_learning_read_events(bool triggered)
 {
     struct mlearn_hmap *mhmap = NULL;
     struct mlearn_hmap_node *mlearn_node = NULL;
-    enum ovsdb_idl_txn_status status;
-    struct ovsdb_idl_txn *mac_txn = NULL;
+    struct mac_event_ring *ring;
+    struct mlearn_event event;
 
     struct asic_plugin_interface *p_asic_interface = NULL;
 
-    if (!idl) {
-        VLOG_ERR("%s: mac learning init hasn't happened yet", __FUNCTION__);
+    atomic_read(&event_ring, &ring);
+    while (mac_event_ring_pop(ring, &event)) {
+        mac_learning_apply_event(&event);
+    }
+
+    if (!triggered) {
         return;
     }
 
@@ -341,44 +1093,96 @@ mac_learning_update_db(void)
         VLOG_ERR("%s: unable to find asic interface", __FUNCTION__);
         return;
     } else if (!p_asic_interface->get_mac_learning_hmap) {
-        VLOG_ERR("%s: get_mac_learning_hmap is null", __FUNCTION__);
+        /* The asic plugin only posts events. */
         return;
     } else {
         p_asic_interface->get_mac_learning_hmap(&mhmap);
     }
 
     if (mhmap) {
-        if (!mac_txn) {
-            mac_txn = ovsdb_idl_txn_create(idl);
-            if (!mac_txn) {
-                VLOG_ERR("%s: Unable to create transaction", __FUNCTION__);
-                return;
-            }
-        }
-
         HMAP_FOR_EACH(mlearn_node, hmap_node, &(mhmap->table)) {
-            if (mlearn_node->oper == MLEARN_ADD
-                || mlearn_node->oper == MLEARN_MOVE) {
-                /* add/move learnt mac to MAC table */
-                mlearn_plugin_db_add_local_mac_entry(mlearn_node, mac_txn);
-            } else {
-                /* delete mac from the MAC table */
-                mlearn_plugin_db_del_local_mac_entry(mlearn_node);
-            }
-        }
-        if (mac_txn) {
-            status = ovsdb_idl_txn_commit(mac_txn);
-            if (status == TXN_ERROR) {
-                VLOG_ERR("%s: commit failed, status: %d", __FUNCTION__, status);
-            }
-            ovsdb_idl_txn_destroy(mac_txn);
-            mac_txn = NULL;
+            mlearn_event_from_hmap_node(&event, mlearn_node);
+            mac_learning_apply_event(&event);
         }
     } else {
         VLOG_ERR("%s: hash map is NULL", __FUNCTION__);
     }
 }
 
+/*
+ * Function: mac_learning_update_db
+ *
+ * This function is invoked at the end of the main loop iteration, while no
+ * previous write is in flight.  It creates, updates or removes, within
+ * 'mac_txn', the rows of up to MAC_LEARNING_TXN_MAX_ROWS dirty MAC entries,
+ * the oldest first.  The remaining ones wait for the next write, so that a
+ * burst of MAC events is spread over several small transactions.
+ */
+static void
+mac_learning_update_db(struct ovsdb_idl_txn *mac_txn, void *aux OVS_UNUSED)
+{
+    int n;
+
+    if (!idl) {
+        VLOG_ERR("%s: mac learning init hasn't happened yet", __FUNCTION__);
+        return;
+    }
+
+    mac_write_seqno++;
+
+    for (n = 0; n < MAC_LEARNING_TXN_MAX_ROWS
+                && !list_is_empty(&dirty_mac_entries); n++) {
+        struct mlearn_mac_entry *entry;
+
+        entry = CONTAINER_OF(list_pop_front(&dirty_mac_entries),
+                             struct mlearn_mac_entry, dirty_node);
+        entry->dirty = false;
+        mlearn_mac_sync(entry, mac_txn);
+    }
+    n_writes += n;
+}
+
+/* Makes the entries the write 'mac_done_seqno' failed to write dirty
+ * again. */
+static void
+mac_learning_write_failed(enum ovsdb_idl_txn_status status)
+{
+    struct mlearn_mac_entry *entry;
+
+    if (status == TXN_ERROR) {
+        VLOG_ERR("%s: commit failed, status: %d", __FUNCTION__, status);
+    }
+
+    /* The rows this write inserted will never show up, those it deleted are
+     * still there, and the ports and flags it set were not: write them
+     * again. */
+    HMAP_FOR_EACH (entry, hmap_node, &mac_entries) {
+        if (entry->deleting && entry->delete_seqno == mac_done_seqno) {
+            entry->deleting = false;
+        }
+        if (entry->inserting && entry->insert_seqno == mac_done_seqno) {
+            entry->inserting = false;
+            mlearn_mac_set_dirty(entry);
+        } else if (entry->row && !entry->deleting
+                   && mlearn_mac_row_is_stale(entry)) {
+            mlearn_mac_set_dirty(entry);
+        }
+    }
+}
+
+static void
+mac_learning_update_db_done(enum ovsdb_idl_txn_status status,
+                            void *aux OVS_UNUSED)
+{
+    mac_done_seqno++;
+    if (status != TXN_SUCCESS && status != TXN_UNCHANGED) {
+        mac_learning_write_failed(status);
+    }
+
+    /* The next chunk, if any, is written in this same iteration. */
+    mlearn_mac_request_write();
+}
+
 /*
  * Function: mac_learning_wait_seq
  *
@@ -553,8 +1357,6 @@ mac_flush_on_vlan(const struct ovsrec_vlan *row)
 {
     mac_flush_params_t  settings;
     int rc = 0;
-    struct ovsdb_idl_txn *txn = NULL;
-    enum ovsdb_idl_txn_status status = TXN_SUCCESS;
     struct asic_plugin_interface *p_asic_interface = NULL;
 
     p_asic_interface = get_plugin_asic_interface();
@@ -570,8 +1372,6 @@ mac_flush_on_vlan(const struct ovsrec_vlan *row)
     settings.options = L2MAC_FLUSH_BY_VLAN;
     settings.vlan = (int)row->id;
 
-    txn = ovsdb_idl_txn_create(idl);
-
     rc = (p_asic_interface->l2_addr_flush
              ? p_asic_interface->l2_addr_flush(&settings)
              : -1);
@@ -581,16 +1381,13 @@ mac_flush_on_vlan(const struct ovsrec_vlan *row)
                  (int)row->id);
     }
 
-    ovsrec_vlan_set_macs_invalid(row, NULL, 0);
-    status = ovsdb_idl_txn_commit(txn);
-
-    if (status == TXN_ERROR)    {
-        ovsdb_idl_txn_abort(txn);
-        VLOG_ERR("%s: VLAN %s flush commit failed\n",
-                 __FUNCTION__, row->name);
+    /* The request is cleared by mac_flush_update_db(). */
+    if (n_flushed_vlans >= allocated_flushed_vlans) {
+        flushed_vlans = x2nrealloc(flushed_vlans, &allocated_flushed_vlans,
+                                   sizeof *flushed_vlans);
     }
-
-    ovsdb_idl_txn_destroy(txn);
+    flushed_vlans[n_flushed_vlans++] = row;
+    txn_writer_request(&mac_flush_writer);
     return;
 }
 
@@ -604,8 +1401,6 @@ mac_flush_on_port(const struct ovsrec_port *row)
 {
     mac_flush_params_t settings;
     int rc = 0, i = 0;
-    struct ovsdb_idl_txn *txn;
-    enum ovsdb_idl_txn_status status = TXN_SUCCESS;
     bool modified = false;
     struct asic_plugin_interface *p_asic_interface = NULL;
     int bond_hw_handle = -1;
@@ -697,24 +1492,54 @@ mac_flush_on_port(const struct ovsrec_port *row)
         return;
     }
 
-    txn = ovsdb_idl_txn_create(idl);
+    /* The request is cleared by mac_flush_update_db(). */
+    if (n_flushed_ports >= allocated_flushed_ports) {
+        flushed_ports = x2nrealloc(flushed_ports, &allocated_flushed_ports,
+                                   sizeof *flushed_ports);
+    }
+    flushed_ports[n_flushed_ports++] = row;
+    txn_writer_request(&mac_flush_writer);
+    return;
+}
+
+/*
+ * Function: mac_flush_update_db
+ *
+ * This function clears, within 'txn', the flush requests of the ports and
+ * VLANs flushed during this main loop iteration.
+ */
+static void
+mac_flush_update_db(struct ovsdb_idl_txn *txn OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    size_t i;
+
+    for (i = 0; i < n_flushed_ports; i++) {
+        const struct ovsrec_port *row = flushed_ports[i];
 
-    ovsrec_port_set_macs_invalid(row, NULL, 0);
-    ovsrec_port_verify_macs_invalid(row);
-    ovsrec_port_set_macs_invalid_on_vlans(row, NULL, 0);
-    ovsrec_port_verify_macs_invalid_on_vlans(row);
-    status = ovsdb_idl_txn_commit(txn);
+        ovsrec_port_set_macs_invalid(row, NULL, 0);
+        ovsrec_port_verify_macs_invalid(row);
+        ovsrec_port_set_macs_invalid_on_vlans(row, NULL, 0);
+        ovsrec_port_verify_macs_invalid_on_vlans(row);
+    }
+    n_flushed_ports = 0;
 
+    for (i = 0; i < n_flushed_vlans; i++) {
+        ovsrec_vlan_set_macs_invalid(flushed_vlans[i], NULL, 0);
+    }
+    n_flushed_vlans = 0;
+}
+
+static void
+mac_flush_update_db_done(enum ovsdb_idl_txn_status status,
+                         void *aux OVS_UNUSED)
+{
     /* Switchd will get change and Later retry the transaction. */
     if (status == TXN_TRY_AGAIN)    {
-        ovsdb_idl_txn_abort(txn);
         poll_timer_wait_until(time_msec() + MAC_FLUSH_RETRY_MSEC);
-        VLOG_ERR("%s: Port %s flush update Try Again \n",
-                 __FUNCTION__, row->name);
+        VLOG_ERR("%s: flush update Try Again \n", __FUNCTION__);
+    } else if (status == TXN_ERROR)    {
+        VLOG_ERR("%s: flush commit failed\n", __FUNCTION__);
     }
-
-    ovsdb_idl_txn_destroy(txn);
-    return;
 }
 
 void
@@ -752,6 +1577,26 @@ l2_addr_flush(void)
 static void
 mac_config_update(void)
 {
+    const struct ovsrec_system *system_row = ovsrec_system_first(idl);
+
+    if (system_row) {
+        const struct smap *other_config = &system_row->other_config;
+
+        mac_learning_event_ring_set_size(
+            smap_get_int(other_config, "mac-learning-event-ring-size",
+                         MAC_EVENT_RING_DFLT_SIZE));
+
+        flap_threshold = MAX(smap_get_int(other_config,
+                                          "mac-learning-flap-threshold",
+                                          MAC_FLAP_DFLT_THRESHOLD), 0);
+        flap_window = MAX(smap_get_int(other_config,
+                                       "mac-learning-flap-window",
+                                       MAC_FLAP_DFLT_WINDOW), 1);
+        flap_hold_down = MAX(smap_get_int(other_config,
+                                          "mac-learning-flap-hold-down",
+                                          MAC_FLAP_DFLT_HOLD_DOWN), 0);
+    }
+
     /* Hanlde MAC table flush requests */
     l2_addr_flush();
 }
@@ -765,8 +1610,20 @@ mac_config_update(void)
 int run (void)
 {
     unsigned int new_idl_seqno = ovsdb_idl_get_seqno(idl);
+    struct mac_event_ring *ring;
+    bool triggered;
 
-    mac_learning_reconfigure();
+    mlearn_mac_track();
+    triggered = mac_learning_reconfigure();
+
+    atomic_read(&event_ring, &ring);
+    mac_learning_event_ring_check(ring);
+    if (resync_needed) {
+        mac_learning_resync();
+    }
+    mac_learning_read_events(triggered);
+    mlearn_mac_flap_run();
+    mlearn_mac_request_write();
 
     /* Check any change in the idl? */
      if (new_idl_seqno != maclearn_idl_seqno) {
@@ -789,6 +1646,7 @@ int run (void)
 int wait (void)
 {
     mac_learning_wait_seq();
+    mlearn_mac_flap_wait();
     return 0;
 }
 
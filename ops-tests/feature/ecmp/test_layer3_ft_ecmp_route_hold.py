@@ -0,0 +1,150 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+OpenSwitch Test for the cold start hold of ECMP routes with unresolved
+nexthops.
+"""
+
+from re import search
+from time import sleep
+
+from pytest import mark
+
+TOPOLOGY = """
+#                             +-------+
+#                             |       |
+#                    +-------->  nh1  |
+#                    |        |       |
+#                    |        +-------+
+#                    |
+# +-------+          |        +-------+
+# |       |     +----v--+     |       |
+# |  hs1  <----->  sw1  <----->  nh2  |
+# |       |     +----^--+     |       |
+# +-------+          |        +-------+
+#                    |
+#                    |        +-------+
+#                    |        |       |
+#                    +-------->  nh3  |
+#                             |       |
+#                             +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+[type=host name="Host 1"] hs1
+[type=host name="Nexthop 1"] nh1
+[type=host name="Nexthop 2"] nh2
+[type=host name="Nexthop 3"] nh3
+
+# Links
+sw1:1 -- nh1:1
+sw1:2 -- nh2:1
+sw1:3 -- nh3:1
+sw1:4 -- hs1:1
+"""
+
+ROUTE_HOLD_MSEC = 30000
+
+
+def get_coverage_total(sw, counter):
+    output = sw('ovs-appctl coverage/show', shell='bash')
+    match = search(r'\n' + counter + r'\s.*total:\s+(\d+)', '\n' + output)
+    if match is None:
+        return 0
+    return int(match.group(1))
+
+
+def nexthops_reached(hs1, nexthops, dst):
+    """
+    Pings 'dst' from 'hs1' and returns the nexthops that forwarded the
+    pings.
+    """
+    for nh in nexthops:
+        nh('tcpdump -ni eth1 dst {} > /tmp/route_hold.txt 2>&1 &'.format(dst),
+           shell='bash')
+    sleep(2)
+    hs1('ping -c 10 -i 0.2 {}'.format(dst))
+    reached = []
+    for nh in nexthops:
+        nh('pkill tcpdump', shell='bash')
+        if '> {}'.format(dst) in nh('cat /tmp/route_hold.txt', shell='bash'):
+            reached.append(nh)
+    return reached
+
+
+@mark.platform_incompatible(['docker'])
+def test_ecmp_route_hold(topology, step):
+    """
+    Restarts switchd with the cold start route hold enabled while none of
+    the nexthops of an ECMP route is resolved.  The route must be held
+    back, then programmed when the hold ends, and forward traffic.
+    """
+    sw1 = topology.get('sw1')
+    hs1 = topology.get('hs1')
+    nh1 = topology.get('nh1')
+    nh2 = topology.get('nh2')
+    nh3 = topology.get('nh3')
+
+    assert sw1 is not None
+    assert hs1 is not None
+    assert nh1 is not None
+    assert nh2 is not None
+    assert nh3 is not None
+
+    hs1.libs.ip.interface('1', addr='20.0.0.10/24', up=True)
+    hs1.libs.ip.add_route('default', '20.0.0.1')
+    nh1.libs.ip.interface('1', addr='1.0.0.1/24', up=True)
+    nh2.libs.ip.interface('1', addr='2.0.0.1/24', up=True)
+    nh3.libs.ip.interface('1', addr='3.0.0.1/24', up=True)
+
+    for port, addr in [('4', '20.0.0.1/24'), ('1', '1.0.0.2/24'),
+                       ('2', '2.0.0.2/24'), ('3', '3.0.0.2/24')]:
+        with sw1.libs.vtysh.ConfigInterface(port) as ctx:
+            ctx.ip_address(addr)
+            ctx.no_shutdown()
+
+    with sw1.libs.vtysh.Configure() as ctx:
+        ctx.ip_route('70.0.0.0/24', '1.0.0.1')
+        ctx.ip_route('70.0.0.0/24', '2.0.0.1')
+        ctx.ip_route('70.0.0.0/24', '3.0.0.1')
+    sleep(5)
+
+    step('Restart switchd with the nexthops unresolved and the hold on')
+    sw1('ovs-vsctl set system . '
+        'other_config:cold-start-route-hold={}'.format(ROUTE_HOLD_MSEC),
+        shell='bash')
+    sw1('ip netns exec swns ip neigh flush all', shell='bash')
+    sw1('systemctl restart switchd', shell='bash')
+    sleep(ROUTE_HOLD_MSEC / 3000)
+
+    held = get_coverage_total(sw1, 'vrf_route_held')
+    released = get_coverage_total(sw1, 'vrf_route_released')
+    assert held >= 1, 'ECMP route not held on cold start'
+    assert released == 0, 'Route released before the hold ended'
+
+    step('Check that the route is programmed when the hold ends')
+    sleep(ROUTE_HOLD_MSEC / 1000)
+    released = get_coverage_total(sw1, 'vrf_route_released')
+    assert released >= 1, 'Held ECMP route not programmed after the hold'
+
+    sw1('ovs-appctl plugin/debug l3ecmp', shell='bash')
+    reached = nexthops_reached(hs1, [nh1, nh2, nh3], '70.0.0.1')
+    assert reached, 'Released ECMP route does not forward'
+
+    sw1('ovs-vsctl remove system . other_config '
+        'cold-start-route-hold', shell='bash')
@@ -0,0 +1,136 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+MAC learning utility functions used in test cases.
+"""
+
+from re import search
+from time import sleep
+
+# Prefix of the source MACs sent by the tests, so that they are told apart
+# from the MACs of the hosts themselves.
+TEST_MAC_PREFIX = '00:00:'
+
+# Sends broadcast frames from 'count' source MACs, starting at 'first', on
+# 'iface', 'loop' times over (0 loops until killed).
+SEND_MACS = (
+    "python -c \"from scapy.all import *; "
+    "pkts = [Ether(src='00:00:%02x:%02x:%02x:01' % "
+    "((i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff), "
+    "dst='ff:ff:ff:ff:ff:ff') / IP() "
+    "for i in range({first}, {first} + {count})]; "
+    "sendp(pkts, iface='{iface}', loop={loop}, inter=0.0001, verbose=0)\""
+)
+
+
+def configure_access_ports(sw, vlan, ports):
+    """
+    Creates 'vlan' and makes each of 'ports' an access port of it.
+    """
+    with sw.libs.vtysh.ConfigVlan(vlan) as ctx:
+        ctx.no_shutdown()
+    for port in ports:
+        with sw.libs.vtysh.ConfigInterface(port) as ctx:
+            ctx.no_routing()
+            ctx.vlan_access(vlan)
+            ctx.no_shutdown()
+
+
+def send_macs(hs, iface, first, count, loop=1):
+    """
+    Sends one broadcast frame from each of 'count' source MACs, starting at
+    'first', through 'iface' of host 'hs'.
+    """
+    hs(SEND_MACS.format(first=first, count=count, iface=iface, loop=loop),
+       shell='bash')
+
+
+def start_mac_flood(hs, iface, first, count):
+    """
+    Like send_macs(), but keeps sending in the background until
+    stop_mac_flood().
+    """
+    hs(SEND_MACS.format(first=first, count=count, iface=iface, loop=0) +
+       ' > /dev/null 2>&1 &', shell='bash')
+
+
+def stop_mac_flood(hs):
+    hs('pkill -f sendp', shell='bash')
+
+
+def get_mac_learning_stats(sw):
+    """
+    Parses 'ovs-appctl mac-learning/show' into a dict keyed by counter name,
+    e.g. 'MAC event ring size'.
+    """
+    stats = {}
+    output = sw('ovs-appctl mac-learning/show', shell='bash')
+    for line in output.splitlines():
+        match = search(r'^(MAC [^:]+):\s+(\d+)', line)
+        if match:
+            stats[match.group(1)] = int(match.group(2))
+    return stats
+
+
+def get_mac_status(sw, mac):
+    """
+    Returns the status column of the MAC table row of 'mac', or None if
+    the MAC is not in the table.
+    """
+    output = sw('ovs-vsctl --bare --columns=status find MAC '
+                'mac_addr="{}"'.format(mac), shell='bash')
+    if not output.strip():
+        return None
+    return output.strip()
+
+
+def get_mac_port(sw, mac):
+    """
+    Returns the name of the port of the MAC table row of 'mac', or None if
+    the MAC is not in the table.
+    """
+    uuid = sw('ovs-vsctl --bare --columns=port find MAC '
+              'mac_addr="{}"'.format(mac), shell='bash').strip()
+    if not uuid:
+        return None
+    return sw('ovs-vsctl --bare --columns=name list Port {}'.format(uuid),
+              shell='bash').strip()
+
+
+def list_macs(sw):
+    """
+    Returns the (MAC, VLAN) of every row of the MAC table for a MAC sent by
+    the tests, duplicates included.
+    """
+    output = sw('ovs-vsctl --bare --columns=mac_addr,vlan list MAC',
+                shell='bash')
+    fields = output.split()
+    return [(mac, vlan) for mac, vlan in zip(fields[0::2], fields[1::2])
+            if mac.startswith(TEST_MAC_PREFIX)]
+
+
+def count_macs(sw):
+    return len(list_macs(sw))
+
+
+def wait_for_mac_count(sw, count, retries=30):
+    for _ in range(retries):
+        if count_macs(sw) == count:
+            return True
+        sleep(1)
+    return False
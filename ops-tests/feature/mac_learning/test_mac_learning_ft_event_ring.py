@@ -0,0 +1,102 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+OpenSwitch Test for resizing the MAC event ring while MACs are learnt.
+"""
+
+from time import sleep
+
+import pytest
+from pytest import mark
+
+from mac_learning_utils import (
+    configure_access_ports, get_mac_learning_stats, start_mac_flood,
+    stop_mac_flood
+)
+
+TOPOLOGY = """
+# +-------+     +-------+     +-------+
+# |  hs1  <----->  sw1  <----->  hs2  |
+# +-------+     +-------+     +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+[type=host name="Host 1"] hs1
+[type=host name="Host 2"] hs2
+
+# Links
+hs1:1 -- sw1:1
+hs2:1 -- sw1:2
+"""
+
+VLAN = 10
+NUM_MACS = 4000
+
+# Ring sizes cycled through while the hosts flood; the last one stays.
+RING_SIZES = [1024, 65536, 2048, 1 << 20, 4096]
+NUM_RESIZES = 50
+
+
+@pytest.mark.timeout(600)
+@mark.gate
+def test_mac_learning_ft_event_ring_resize(topology, step):
+    """
+    Resizes the MAC event ring over and over while both hosts flood frames
+    from thousands of source MACs, so that MAC events are posted during
+    each resize.  switchd must survive it and keep learning.
+    """
+    sw1 = topology.get('sw1')
+    hs1 = topology.get('hs1')
+    hs2 = topology.get('hs2')
+
+    assert sw1 is not None
+    assert hs1 is not None
+    assert hs2 is not None
+
+    configure_access_ports(sw1, VLAN, [sw1.ports['1'], sw1.ports['2']])
+
+    step('Flood frames from {} MACs on each host'.format(NUM_MACS))
+    start_mac_flood(hs1, hs1.ports['1'], 0, NUM_MACS)
+    start_mac_flood(hs2, hs2.ports['1'], NUM_MACS, NUM_MACS)
+    sleep(2)
+
+    step('Resize the MAC event ring {} times'.format(NUM_RESIZES))
+    for i in range(NUM_RESIZES):
+        size = RING_SIZES[i % len(RING_SIZES)]
+        sw1('ovs-vsctl set system . '
+            'other_config:mac-learning-event-ring-size={}'.format(size),
+            shell='bash')
+        sleep(0.2)
+
+    stop_mac_flood(hs1)
+    stop_mac_flood(hs2)
+
+    step('Check that switchd is alive and uses the last ring size')
+    stats = get_mac_learning_stats(sw1)
+    assert stats['MAC event ring size'] == size,\
+        'MAC event ring not resized to {}'.format(size)
+    assert stats['MAC events received'] > 0, 'No MAC event received'
+
+    step('Check that MACs are still learnt after the resizes')
+    received = stats['MAC events received']
+    start_mac_flood(hs1, hs1.ports['1'], 2 * NUM_MACS, NUM_MACS)
+    sleep(5)
+    stop_mac_flood(hs1)
+    stats = get_mac_learning_stats(sw1)
+    assert stats['MAC events received'] > received,\
+        'No MAC event received after the resizes'
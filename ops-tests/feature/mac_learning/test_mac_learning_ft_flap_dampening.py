@@ -0,0 +1,143 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+OpenSwitch Test for MAC flap dampening.
+"""
+
+from time import sleep
+
+import pytest
+from pytest import mark
+
+from mac_learning_utils import (
+    configure_access_ports, get_mac_learning_stats, get_mac_port,
+    get_mac_status, send_macs, start_mac_flood, stop_mac_flood
+)
+
+TOPOLOGY = """
+# +-------+     +-------+     +-------+
+# |  hs1  <----->  sw1  <----->  hs2  |
+# +-------+     +-------+     +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+[type=host name="Host 1"] hs1
+[type=host name="Host 2"] hs2
+
+# Links
+hs1:1 -- sw1:1
+hs2:1 -- sw1:2
+"""
+
+VLAN = 10
+
+# Source MAC sent by send_macs() for index 0.
+MAC = '00:00:00:00:00:01'
+
+FLAP_THRESHOLD = 10
+FLAP_WINDOW = 1000
+FLAP_HOLD_DOWN = 5000
+
+
+def flap(hs1, hs2, seconds):
+    """
+    Sends frames from MAC from both hosts at once for 'seconds', so that it
+    keeps moving between their ports.
+    """
+    start_mac_flood(hs1, hs1.ports['1'], 0, 1)
+    start_mac_flood(hs2, hs2.ports['1'], 0, 1)
+    sleep(seconds)
+    stop_mac_flood(hs1)
+    stop_mac_flood(hs2)
+
+
+@pytest.mark.timeout(600)
+@mark.gate
+def test_mac_learning_ft_flap_dampening(topology, step):
+    """
+    A MAC moving between two ports is only dampened once a flap threshold
+    is configured.  It is then marked flapping in the MAC table, its port
+    is held, and both are released once it stopped moving for the
+    hold-down.
+    """
+    sw1 = topology.get('sw1')
+    hs1 = topology.get('hs1')
+    hs2 = topology.get('hs2')
+
+    assert sw1 is not None
+    assert hs1 is not None
+    assert hs2 is not None
+
+    sw1p1 = sw1.ports['1']
+    sw1p2 = sw1.ports['2']
+    configure_access_ports(sw1, VLAN, [sw1p1, sw1p2])
+
+    step('Check that dampening is off by default')
+    output = sw1('ovs-appctl mac-learning/flaps', shell='bash')
+    assert 'flap threshold: 0 moves' in output
+    flap(hs1, hs2, 5)
+    stats = get_mac_learning_stats(sw1)
+    assert stats['MAC flaps'] == 0, 'MAC dampened with dampening off'
+    assert stats['MAC flapping'] == 0
+    assert 'flapping' not in (get_mac_status(sw1, MAC) or '')
+
+    step('Enable dampening')
+    sw1('ovs-vsctl set system . '
+        'other_config:mac-learning-flap-threshold={} '
+        'other_config:mac-learning-flap-window={} '
+        'other_config:mac-learning-flap-hold-down={}'.format(
+            FLAP_THRESHOLD, FLAP_WINDOW, FLAP_HOLD_DOWN), shell='bash')
+    output = sw1('ovs-appctl mac-learning/flaps', shell='bash')
+    assert 'flap threshold: {} moves in {} ms, hold-down: {} ms'.format(
+        FLAP_THRESHOLD, FLAP_WINDOW, FLAP_HOLD_DOWN) in output
+
+    step('Move the MAC back and forth until it is flapping')
+    start_mac_flood(hs1, hs1.ports['1'], 0, 1)
+    start_mac_flood(hs2, hs2.ports['1'], 0, 1)
+    sleep(3)
+
+    stats = get_mac_learning_stats(sw1)
+    assert stats['MAC flaps'] >= 1, 'Flapping MAC not detected'
+    assert stats['MAC flapping'] == 1
+    assert 'flapping=true' in get_mac_status(sw1, MAC),\
+        'Flapping MAC not marked in the MAC table'
+    assert MAC in sw1('ovs-appctl mac-learning/flaps', shell='bash')
+
+    step('Check that the port of the MAC is held while it flaps')
+    held = get_mac_learning_stats(sw1)['MAC moves held']
+    port = get_mac_port(sw1, MAC)
+    sleep(2)
+    assert get_mac_port(sw1, MAC) == port, 'Port of a flapping MAC written'
+    assert get_mac_learning_stats(sw1)['MAC moves held'] > held
+
+    step('Stop moving the MAC and wait for the hold-down')
+    stop_mac_flood(hs1)
+    stop_mac_flood(hs2)
+    send_macs(hs2, hs2.ports['1'], 0, 1)
+    sleep(FLAP_HOLD_DOWN / 1000 + 3)
+
+    stats = get_mac_learning_stats(sw1)
+    assert stats['MAC flapping'] == 0, 'MAC still flapping after hold-down'
+    assert 'flapping' not in get_mac_status(sw1, MAC),\
+        'Flapping mark not cleared after hold-down'
+    assert get_mac_port(sw1, MAC) == sw1p2,\
+        'Last port of the MAC not written after hold-down'
+
+    sw1('ovs-vsctl remove system . other_config '
+        'mac-learning-flap-threshold mac-learning-flap-window '
+        'mac-learning-flap-hold-down', shell='bash')
@@ -0,0 +1,131 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+OpenSwitch Test for keeping the MAC table in sync with the learnt MACs.
+"""
+
+from time import sleep
+
+import pytest
+from pytest import mark
+
+from mac_learning_utils import (
+    configure_access_ports, get_mac_learning_stats, get_mac_port,
+    list_macs, send_macs, wait_for_mac_count
+)
+
+TOPOLOGY = """
+# +-------+     +-------+     +-------+
+# |  hs1  <----->  sw1  <----->  hs2  |
+# +-------+     +-------+     +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+[type=host name="Host 1"] hs1
+[type=host name="Host 2"] hs2
+
+# Links
+hs1:1 -- sw1:1
+hs2:1 -- sw1:2
+"""
+
+VLAN = 10
+
+# Several times the most MAC rows the plugin writes per transaction,
+# MAC_LEARNING_TXN_MAX_ROWS (1000).
+NUM_MACS = 5000
+
+# Source MACs sent by send_macs() for the first and last index.
+FIRST_MAC = '00:00:00:00:00:01'
+LAST_MAC = '00:00:00:13:87:01'
+
+
+def check_macs(sw1, count):
+    """
+    Waits for the MAC table to hold 'count' rows, and checks that there is
+    a single row per MAC and VLAN and that nothing is left to write.
+    """
+    assert wait_for_mac_count(sw1, count, retries=60),\
+        'MAC table does not have {} rows'.format(count)
+    macs = list_macs(sw1)
+    assert len(set(macs)) == len(macs), 'Duplicate MAC rows'
+    stats = get_mac_learning_stats(sw1)
+    assert stats['MAC rows to write'] == 0
+    assert stats['MAC events lost'] == 0
+    return stats
+
+
+@pytest.mark.timeout(900)
+@mark.gate
+def test_mac_learning_ft_table_sync(topology, step):
+    """
+    Learns, moves, flushes and learns again thousands of MACs, more than fit
+    in one MAC table transaction.  The MAC table must end up with exactly one
+    row per learnt MAC each time, written in several bounded transactions.
+    """
+    sw1 = topology.get('sw1')
+    hs1 = topology.get('hs1')
+    hs2 = topology.get('hs2')
+
+    assert sw1 is not None
+    assert hs1 is not None
+    assert hs2 is not None
+
+    sw1p1 = sw1.ports['1']
+    sw1p2 = sw1.ports['2']
+    configure_access_ports(sw1, VLAN, [sw1p1, sw1p2])
+
+    step('Learn {} MACs on port {}'.format(NUM_MACS, sw1p1))
+    stats = get_mac_learning_stats(sw1)
+    written = stats['MAC rows written']
+    send_macs(hs1, hs1.ports['1'], 0, NUM_MACS)
+    stats = check_macs(sw1, NUM_MACS)
+    assert get_mac_port(sw1, FIRST_MAC) == sw1p1
+    assert get_mac_port(sw1, LAST_MAC) == sw1p1
+
+    # Each MAC is written once, however many transactions it takes.  The
+    # hosts may add a few MACs of their own.
+    assert NUM_MACS <= stats['MAC rows written'] - written < 2 * NUM_MACS,\
+        'MAC rows written more than once'
+
+    step('Move the MACs to port {}'.format(sw1p2))
+    written = stats['MAC rows written']
+    send_macs(hs2, hs2.ports['1'], 0, NUM_MACS)
+    sleep(5)
+    stats = check_macs(sw1, NUM_MACS)
+    assert NUM_MACS <= stats['MAC rows written'] - written < 2 * NUM_MACS
+    assert get_mac_port(sw1, FIRST_MAC) == sw1p2
+    assert get_mac_port(sw1, LAST_MAC) == sw1p2
+
+    step('Send the MACs again on the same port')
+    written = stats['MAC rows written']
+    send_macs(hs2, hs2.ports['1'], 0, NUM_MACS)
+    sleep(5)
+    stats = check_macs(sw1, NUM_MACS)
+    assert stats['MAC rows written'] - written < NUM_MACS,\
+        'MAC rows written although their port did not change'
+
+    step('Flush the MACs by deleting the VLAN, then learn them again')
+    with sw1.libs.vtysh.Configure() as ctx:
+        ctx.no_vlan(VLAN)
+    check_macs(sw1, 0)
+    configure_access_ports(sw1, VLAN, [sw1p1, sw1p2])
+    send_macs(hs1, hs1.ports['1'], 0, NUM_MACS)
+    stats = check_macs(sw1, NUM_MACS)
+    assert get_mac_port(sw1, FIRST_MAC) == sw1p1
+    assert stats['MAC table resyncs'] == 0
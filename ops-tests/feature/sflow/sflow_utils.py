@@ -19,6 +19,8 @@
 sFlow utility functions used in test cases.
 """
 
+import re
+
 
 def check_ping_sample(sflow_output, host1, host2, agent_address, family):
     """
@@ -83,3 +85,24 @@ def check_ping_sample(sflow_output, host1, host2, agent_address, family):
     # TODO: Need to check for both ping request and response(CR 1983)
     result = ping_request or ping_response
     return result
+
+
+def show_sflow_counters(ops1):
+    """
+    Parse the counters published by switchd out of 'show sflow'.
+
+    :param ops1: switch to run 'show sflow' on
+    :return dict counters: 'effective_sampling_rate' (None if not shown),
+                           'samples' and 'samples_per_sec'
+    """
+
+    output = ops1('show sflow')
+    counters = {'effective_sampling_rate': None}
+    for key, label in [('effective_sampling_rate', 'Effective Sampling Rate'),
+                       ('samples', 'Number of Samples'),
+                       ('samples_per_sec', 'Samples per Second')]:
+        match = re.search(label + r'\s+(\d+)', output)
+        if match:
+            counters[key] = int(match.group(1))
+    assert 'samples' in counters and 'samples_per_sec' in counters
+    return counters
@@ -0,0 +1,153 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""
+OpenSwitch Test for the sFlow sampling governor.
+"""
+
+import pytest
+import time
+from pytest import mark
+TOPOLOGY = """
+#
+# +-------+     +-------+     +-------+
+# |  hs1  <----->  ops1 <----->  hs2  |
+# +-------+     +-------+     +-------+
+#
+
+# Nodes
+[type=openswitch name="OpenSwitch"] ops1
+[type=host name="Host 1"] hs1
+[type=host name="Host 2"] hs2
+
+# Links
+hs1:1 -- ops1:1
+hs2:1 -- ops1:2
+"""
+
+# Intervals of the governor, see SFLOW_GOVERNOR_INTERVAL and
+# SFLOW_GOVERNOR_CALM_INTERVALS.
+GOVERNOR_INTERVAL = 5
+GOVERNOR_CALM_INTERVALS = 3
+GOVERNOR_MAX_FACTOR = 64
+
+
+def get_sflow_statistic(ops1, key):
+    """
+    Returns the value of 'key' in the statistics column of the sFlow row, or
+    None if it is not there.
+    """
+    output = ops1('ovs-vsctl --if-exists get sflow {} statistics:{}'.format(
+        ops1('ovs-vsctl --bare --columns=_uuid list sflow',
+             shell='bash').strip(), key), shell='bash').strip()
+    if not output:
+        return None
+    return int(output.strip('"'))
+
+
+def wait_for_rate(ops1, done, timeout):
+    """
+    Polls the effective sampling rate until done(rate) or 'timeout' seconds
+    elapsed, and returns the last rate read.
+    """
+    deadline = time.time() + timeout
+    rate = get_sflow_statistic(ops1, 'effective_sampling_rate')
+    while not done(rate) and time.time() < deadline:
+        time.sleep(1)
+        rate = get_sflow_statistic(ops1, 'effective_sampling_rate')
+    return rate
+
+
+@mark.platform_incompatible(['docker'])
+@pytest.mark.timeout(1000)
+def test_sflow_ft_governor(topology, step):
+    """
+    Floods a low sampling rate with traffic until the COPP class of the sFlow
+    samples drops some.  The governor must double the effective rate, then
+    halve it back to the configured one once the flood stops.  Other keys of
+    the statistics column must survive the updates.
+    """
+    ops1 = topology.get('ops1')
+    hs1 = topology.get('hs1')
+    hs2 = topology.get('hs2')
+
+    assert ops1 is not None
+    assert hs1 is not None
+    assert hs2 is not None
+
+    sampling_rate = 16
+    p1 = ops1.ports['1']
+
+    step("### Configuring host interfaces ###")
+    hs1.libs.ip.interface('1', addr='10.10.10.2/24', up=True)
+    hs2.libs.ip.interface('1', addr='10.10.11.2/24', up=True)
+    hs1.libs.ip.add_route('10.10.11.0/24', '10.10.10.1')
+    hs2.libs.ip.add_route('10.10.10.0/24', '10.10.11.1')
+
+    with ops1.libs.vtysh.ConfigInterface('1') as ctx:
+        ctx.ip_address('10.10.10.1/24')
+        ctx.no_shutdown()
+    with ops1.libs.vtysh.ConfigInterface('2') as ctx:
+        ctx.ip_address('10.10.11.1/24')
+        ctx.no_shutdown()
+
+    step("### Configuring sFlow and its governor ###")
+    with ops1.libs.vtysh.Configure() as ctx:
+        ctx.sflow_enable()
+        ctx.sflow_sampling(sampling_rate)
+        ctx.sflow_agent_interface(p1)
+        ctx.sflow_collector('10.10.11.2')
+
+    # Only the COPP drops make the rate grow, and every interval without
+    # them is calm.
+    ops1('ovs-vsctl set system . other_config:sflow-governor=true '
+         'other_config:sflow-governor-cpu-high=100 '
+         'other_config:sflow-governor-cpu-low=100', shell='bash')
+
+    # Stands for a key written by another daemon.
+    ops1('ovs-vsctl set sflow {} statistics:governor_test=7'.format(
+        ops1('ovs-vsctl --bare --columns=_uuid list sflow',
+             shell='bash').strip()), shell='bash')
+
+    rate = wait_for_rate(ops1, lambda r: r == sampling_rate,
+                         2 * GOVERNOR_INTERVAL)
+    assert rate == sampling_rate
+
+    step("### Flooding until the sFlow samples are dropped ###")
+    hs1('ping -f -q 10.10.11.2 > /dev/null 2>&1 &', shell='bash')
+    rate = wait_for_rate(ops1, lambda r: r > sampling_rate,
+                         12 * GOVERNOR_INTERVAL)
+    hs1('pkill ping', shell='bash')
+
+    assert rate > sampling_rate, "Sampling rate did not grow under drops"
+    assert rate <= GOVERNOR_MAX_FACTOR * sampling_rate
+    assert rate % (2 * sampling_rate) == 0,\
+        "Sampling rate {} is not a doubling of {}".format(rate, sampling_rate)
+    assert get_sflow_statistic(ops1, 'governor_test') == 7,\
+        "Statistics written by others were lost"
+
+    step("### Checking that the rate halves back without drops ###")
+    halvings = GOVERNOR_MAX_FACTOR.bit_length()
+    rate = wait_for_rate(ops1, lambda r: r == sampling_rate,
+                         (halvings + 1) * GOVERNOR_CALM_INTERVALS
+                         * GOVERNOR_INTERVAL)
+    assert rate == sampling_rate, "Sampling rate did not come back down"
+    assert get_sflow_statistic(ops1, 'governor_test') == 7,\
+        "Statistics written by others were lost"
+
+    ops1('ovs-vsctl remove system . other_config sflow-governor',
+         shell='bash')
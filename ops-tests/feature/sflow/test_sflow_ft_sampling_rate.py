@@ -22,6 +22,7 @@ OpenSwitch Test for sFlow sampling rate configuration changes.
 import pytest
 import time
 from pytest import mark
+import sflow_utils
 TOPOLOGY = """
 #                    +----------------+
 #                    |                |
@@ -137,6 +138,15 @@ def test_sflow_ft_sampling_rate(topology, step):
     for x in range(0, count):
         hs1.libs.ping.ping(ping_count, '10.10.11.2', ping_interval, quiet)
 
+    # The sample rate is published while the traffic flows
+    step("### Checking sFlow counters under traffic ###")
+    hs1('ping -q -c {} -i {} 10.10.11.2 > /dev/null 2>&1 &'.format(
+        int(ping_count), ping_interval), shell='bash')
+    time.sleep(6)
+    counters = sflow_utils.show_sflow_counters(ops1)
+    assert counters['samples_per_sec'] > 0
+    assert counters['effective_sampling_rate'] == sampling_rate
+
     time.sleep(15)
     # Stop sflowtool
     result = hs2.libs.sflowtool.stop()
@@ -152,6 +162,12 @@ def test_sflow_ft_sampling_rate(topology, step):
                 packet['eth_type'] == '0x0800':
             assert int(packet['sampling_rate']) == sampling_rate
 
+    # Every sample the collector got is in the aggregated counters
+    counters = sflow_utils.show_sflow_counters(ops1)
+    assert counters['samples'] >= result['flow_count']
+    assert counters['effective_sampling_rate'] == sampling_rate
+    samples = counters['samples']
+
     # Configure new sampling rate
     step("### Configuring sFlow ###")
     sampling_rate = 4096
@@ -170,6 +186,11 @@ def test_sflow_ft_sampling_rate(topology, step):
 
     time.sleep(20)
 
+    # switchd applied the new rate, and the counters carry over
+    counters = sflow_utils.show_sflow_counters(ops1)
+    assert counters['effective_sampling_rate'] == sampling_rate
+    assert counters['samples'] >= samples
+
     # Start sflowtool
     hs2.libs.sflowtool.start(mode='line')
     for x in range(0, count):
@@ -187,3 +208,7 @@ def test_sflow_ft_sampling_rate(topology, step):
         if str(packet['packet_type']) == 'FLOW' and \
                 packet['eth_type'] == '0x0800':
             assert int(packet['sampling_rate']) == sampling_rate
+
+    counters = sflow_utils.show_sflow_counters(ops1)
+    assert counters['samples'] >= samples + result['flow_count']
+    assert counters['effective_sampling_rate'] == sampling_rate
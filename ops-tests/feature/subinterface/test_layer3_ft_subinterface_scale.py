@@ -0,0 +1,143 @@
+# Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+##########################################################################
+# Name:        test_layer3_ft_subinterface_scale.py
+#
+# Objective:   Scale benchmark for subinterfaces. With 4k subinterfaces
+#              configured, verify that a reconfiguration that does not
+#              touch them does not push their configuration again, and
+#              report how long such a reconfiguration takes.
+#
+# Topology:    1 switch, 1 host
+#
+##########################################################################
+
+"""
+OpenSwitch Tests for subinterface reconfiguration at scale
+"""
+
+from re import search
+from time import sleep, time
+
+from pytest import mark
+
+TOPOLOGY = """
+# +-------+     +-------+
+# |  hs1  <----->  sw1  |
+# +-------+     +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+[type=host name="Host 1"] hs1
+
+# Links
+hs1:1 -- sw1:1
+"""
+
+NUM_SUBINTERFACES = 4000
+
+# Number of subinterfaces configured per vtysh invocation.
+BATCH_SIZE = 250
+
+
+def get_coverage_total(sw, counter):
+    output = sw('ovs-appctl coverage/show', shell='bash')
+    match = search(r'\n' + counter + r'\s.*total:\s+(\d+)', '\n' + output)
+    if match is None:
+        return 0
+    return int(match.group(1))
+
+
+def configure_subinterfaces(sw, interface, first, last):
+    cmd = 'vtysh -c "configure terminal"'
+    for sub_id in range(first, last + 1):
+        cmd += (' -c "interface {0}.{1}"'
+                ' -c "encapsulation dot1Q {1}"'
+                ' -c "no shutdown"').format(interface, sub_id)
+    sw(cmd, shell='bash')
+
+
+def wait_for_route(sw, network, retries=30):
+    for _ in range(retries):
+        routes = sw.libs.vtysh.show_ip_route()
+        for item in routes:
+            if item['id'] == network:
+                return True
+        sleep(1)
+    return False
+
+
+@mark.platform_incompatible(['docker'])
+def test_subinterface_scale(topology):
+    """Test description.
+
+    Topology:
+
+        [s1]
+
+    Objective:
+        Verify that reconfigurations that do not touch the subinterfaces
+        skip them, with 4k subinterfaces configured.
+
+    Cases:
+        - Configure 4k subinterfaces on one interface.
+        - Configure a static route and report how long it takes.
+        - Bring up an unrelated interface and check that the subinterface
+          configuration is not pushed again.
+    """
+    sw1 = topology.get('sw1')
+
+    assert sw1 is not None
+
+    sw1p1 = sw1.ports['1']
+
+    with sw1.libs.vtysh.ConfigInterface(sw1p1) as ctx:
+        ctx.ip_address('1.1.1.1/24')
+        ctx.no_shutdown()
+
+    print('Create {} subinterfaces'.format(NUM_SUBINTERFACES))
+    start = time()
+    for first in range(1, NUM_SUBINTERFACES + 1, BATCH_SIZE):
+        last = min(first + BATCH_SIZE - 1, NUM_SUBINTERFACES)
+        configure_subinterfaces(sw1, sw1p1, first, last)
+    print('Subinterfaces created in {:.1f} s'.format(time() - start))
+
+    # Let switchd settle before taking the baseline.
+    sleep(10)
+    applied = get_coverage_total(sw1, 'bridge_subintf_reconfigure')
+    unchanged = get_coverage_total(sw1, 'bridge_subintf_unchanged')
+
+    print('Configure a static route')
+    start = time()
+    with sw1.libs.vtysh.Configure() as ctx:
+        ctx.ip_route('3.3.3.0/24', '1.1.1.2')
+    assert wait_for_route(sw1, '3.3.3.0'), 'Route not configured'
+    print('Route configured in {:.1f} s'.format(time() - start))
+
+    print('Bring up an unrelated interface')
+    with sw1.libs.vtysh.ConfigInterface('2') as ctx:
+        ctx.no_shutdown()
+    sleep(5)
+
+    new_applied = get_coverage_total(sw1, 'bridge_subintf_reconfigure')
+    new_unchanged = get_coverage_total(sw1, 'bridge_subintf_unchanged')
+    print('Subinterfaces reconfigured: {}, skipped: {}'.format(
+        new_applied - applied, new_unchanged - unchanged))
+
+    assert new_applied == applied,\
+        'Subinterface configuration pushed again on an unrelated change'
+    assert new_unchanged - unchanged >= NUM_SUBINTERFACES,\
+        'Subinterfaces were not walked on an interface change'
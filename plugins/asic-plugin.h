@@ -47,6 +47,8 @@
 #include <stdlib.h>
 #include "mac-learning-plugin.h"
 
+struct ofproto;
+
 /** @def ASIC_PLUGIN_INTERFACE_NAME
  *  @brief asic plugin name definition
  */
@@ -60,7 +62,17 @@
 /** @def ASIC_PLUGIN_INTERFACE_MINOR
  *  @brief plugin minor version definition
  */
-#define ASIC_PLUGIN_INTERFACE_MINOR    1
+#define ASIC_PLUGIN_INTERFACE_MINOR    3
+
+/** @def ASIC_PLUGIN_SET_VLANS_MINOR
+ *  @brief first minor version providing set_vlans
+ */
+#define ASIC_PLUGIN_SET_VLANS_MINOR    2
+
+/** @def ASIC_PLUGIN_L2_ADDR_WALK_MINOR
+ *  @brief first minor version providing l2_addr_walk
+ */
+#define ASIC_PLUGIN_L2_ADDR_WALK_MINOR 3
 
 /* structures */
 
@@ -125,6 +137,20 @@ struct asic_plugin_interface {
 
     /* flush mac's from the MAC table*/
     int (*l2_addr_flush)(mac_flush_params_t *params);
+
+    /* enable the vlans set in 'add' and disable the ones set in 'del' on
+     * 'ofproto', both bitmaps of 4096 bits. Returns 0 on success. May be NULL,
+     * in which case vlans are set one at a time through ofproto. */
+    int (*set_vlans)(struct ofproto *ofproto, const unsigned long *add,
+                     const unsigned long *del);
+
+    /* call 'cb' with an MLEARN_ADD event for each dynamic MAC address of the
+     * L2 table, from the calling thread, before returning.  Used to resync
+     * the MAC table once MAC events were lost.  Returns 0 on success.  May be
+     * NULL. */
+    int (*l2_addr_walk)(void (*cb)(const struct mlearn_event *event,
+                                   void *aux),
+                        void *aux);
 };
 
 #endif /*__ASIC_PLUGIN_H__*/
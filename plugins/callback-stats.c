@@ -0,0 +1,131 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1               /* For dladdr(). */
+#endif
+
+#include <config.h>
+#include <dlfcn.h>
+#include <string.h>
+#include "callback-stats.h"
+#include "coverage.h"
+#include "dynamic-string.h"
+#include "timeval.h"
+#include "unixctl.h"
+#include "openvswitch/vlog.h"
+#include "util.h"
+
+VLOG_DEFINE_THIS_MODULE(callback_stats);
+
+COVERAGE_DEFINE(plugin_callback_slow);
+
+static struct ovs_list all_callback_stats
+    = OVS_LIST_INITIALIZER(&all_callback_stats);
+
+/* Calls longer than this are logged, in usec.  0 disables the warning. */
+static long long int slow_threshold_usec
+    = CALLBACK_STATS_DFLT_SLOW_THRESHOLD * 1000LL;
+
+static unixctl_cb_func callback_stats_unixctl_show;
+
+void
+callback_stats_init(void)
+{
+    unixctl_command_register("plugins/callback-stats", "", 0, 0,
+                             callback_stats_unixctl_show, NULL);
+}
+
+struct callback_stats *
+callback_stats_create(const char *kind, const char *block,
+                      void (*func)(void))
+{
+    struct callback_stats *stats;
+    Dl_info info;
+
+    stats = xzalloc(sizeof *stats);
+    stats->kind = kind;
+    stats->block = block;
+
+    if (dladdr((void *) func, &info) && info.dli_fname) {
+        const char *slash = strrchr(info.dli_fname, '/');
+
+        stats->plugin = xstrdup(slash ? slash + 1 : info.dli_fname);
+        if (info.dli_sname && info.dli_saddr == (void *) func) {
+            stats->function = xstrdup(info.dli_sname);
+        }
+    } else {
+        stats->plugin = xstrdup("unknown");
+    }
+    if (!stats->function) {
+        stats->function = xasprintf("%p", (void *) func);
+    }
+
+    list_push_back(&all_callback_stats, &stats->node);
+    return stats;
+}
+
+void
+callback_stats_account(struct callback_stats *stats, long long int start)
+{
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    long long int usec = time_usec() - start;
+
+    stats->n_calls++;
+    stats->total_usec += usec;
+    stats->max_usec = MAX(stats->max_usec, usec);
+
+    if (slow_threshold_usec && usec >= slow_threshold_usec) {
+        COVERAGE_INC(plugin_callback_slow);
+        VLOG_WARN_RL(&rl, "%s callback %s of plugin %s in block %s took "
+                     "%lld ms", stats->kind, stats->function, stats->plugin,
+                     stats->block, usec / 1000);
+    }
+}
+
+void
+callback_stats_set_slow_threshold(int msec)
+{
+    slow_threshold_usec = MAX(msec, 0) * 1000LL;
+}
+
+static void
+callback_stats_unixctl_show(struct unixctl_conn *conn,
+                            int argc OVS_UNUSED,
+                            const char *argv[] OVS_UNUSED,
+                            void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    const struct callback_stats *stats;
+
+    ds_put_format(&ds, "slow callback threshold: %lld ms\n",
+                  slow_threshold_usec / 1000);
+    ds_put_format(&ds, "%-12s %-28s %-24s %-32s %-10s %-12s %-10s %s\n",
+                  "kind", "block", "plugin", "callback", "calls",
+                  "total(us)", "avg(us)", "max(us)");
+    LIST_FOR_EACH (stats, node, &all_callback_stats) {
+        ds_put_format(&ds,
+                      "%-12s %-28s %-24s %-32s %-10llu %-12lld %-10lld %lld\n",
+                      stats->kind, stats->block, stats->plugin,
+                      stats->function, stats->n_calls, stats->total_usec,
+                      stats->n_calls
+                      ? stats->total_usec / (long long int) stats->n_calls
+                      : 0,
+                      stats->max_usec);
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
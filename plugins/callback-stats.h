@@ -0,0 +1,70 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CALLBACK_STATS_H
+#define CALLBACK_STATS_H
+
+#include "list.h"
+
+/* Callback statistics account for every callback registered by the plugins
+ * into the reconfigure, stats and run blocks: number of calls, cumulative and
+ * highest duration, and the plugin library the callback belongs to, resolved
+ * with dladdr() when it is registered.
+ *
+ * A call that lasts longer than the slow callback threshold is logged (rate
+ * limited) with its plugin, so that a plugin stalling the main loop can be
+ * told apart from SwitchD itself.  The threshold comes from
+ * "slow-callback-threshold" in the Open_vSwitch other_config column, in msec,
+ * and 0 disables the warning.
+ *
+ * The statistics are shown by the "plugins/callback-stats" unixctl command.
+ *
+ * Callback Statistics API
+ *
+ * callback_stats_init: registers the unixctl command.
+ *
+ * callback_stats_create: returns the statistics of the callback 'func'
+ * registered into the block 'block' of the 'kind' blocks.  The block modules
+ * keep it in their node for the callback.
+ *
+ * callback_stats_account: accounts a call of the callback started at 'start',
+ * as returned by time_usec().
+ *
+ * callback_stats_set_slow_threshold: sets the slow callback threshold.
+ */
+
+#define CALLBACK_STATS_DFLT_SLOW_THRESHOLD 100   /* msec */
+
+struct callback_stats {
+    const char *kind;               /* "reconfigure", "stats" or "run". */
+    const char *block;              /* Name of the block. */
+    char *plugin;                   /* Plugin library of the callback. */
+    char *function;                 /* Symbol of the callback, if known. */
+
+    unsigned long long int n_calls;
+    long long int total_usec;       /* Cumulative duration of the calls. */
+    long long int max_usec;         /* Longest call. */
+
+    struct ovs_list node;           /* In 'all_callback_stats'. */
+};
+
+void callback_stats_init(void);
+struct callback_stats *callback_stats_create(const char *kind,
+                                             const char *block,
+                                             void (*func)(void));
+void callback_stats_account(struct callback_stats *, long long int start);
+void callback_stats_set_slow_threshold(int msec);
+
+#endif /* callback-stats.h */
@@ -0,0 +1,124 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+#include <string.h>
+#include "latency-hist.h"
+#include "dynamic-string.h"
+#include "util.h"
+
+#define SUB_BUCKETS (1 << LATENCY_HIST_SUB_BITS)
+
+/* Returns the bucket of a sample of 'usec'. */
+static int
+latency_hist_bucket(long long int usec)
+{
+    int msb;
+
+    if (usec < SUB_BUCKETS) {
+        return usec > 0 ? usec : 0;
+    }
+    msb = log_2_floor(usec);
+    if (msb >= LATENCY_HIST_MAX_BITS) {
+        return LATENCY_HIST_N_BUCKETS - 1;
+    }
+    return ((msb - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+           + ((usec >> (msb - LATENCY_HIST_SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/* Returns the highest sample that falls into 'bucket'. */
+static long long int
+latency_hist_bucket_top(int bucket)
+{
+    int shift;
+
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    shift = (bucket >> LATENCY_HIST_SUB_BITS) - 1;
+    return ((long long int) (SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1)))
+            << shift) + (1LL << shift) - 1;
+}
+
+void
+latency_hist_add(struct latency_hist *hist, long long int usec)
+{
+    if (hist->n[hist->cur] >= LATENCY_HIST_WINDOW) {
+        hist->cur = !hist->cur;
+        memset(hist->counts[hist->cur], 0, sizeof hist->counts[hist->cur]);
+        hist->n[hist->cur] = 0;
+        hist->max[hist->cur] = 0;
+    }
+
+    hist->counts[hist->cur][latency_hist_bucket(usec)]++;
+    hist->n[hist->cur]++;
+    hist->max[hist->cur] = MAX(hist->max[hist->cur], usec);
+
+    hist->n_total++;
+    hist->max_total = MAX(hist->max_total, usec);
+}
+
+unsigned int
+latency_hist_count(const struct latency_hist *hist)
+{
+    return hist->n[0] + hist->n[1];
+}
+
+long long int
+latency_hist_max(const struct latency_hist *hist)
+{
+    return MAX(hist->max[0], hist->max[1]);
+}
+
+long long int
+latency_hist_percentile(const struct latency_hist *hist, double p)
+{
+    unsigned int n = latency_hist_count(hist);
+    unsigned int rank, seen;
+    int i;
+
+    if (!n) {
+        return 0;
+    }
+
+    rank = MAX(1, (unsigned int) (p / 100.0 * n + 0.5));
+    seen = 0;
+    for (i = 0; i < LATENCY_HIST_N_BUCKETS; i++) {
+        seen += hist->counts[0][i] + hist->counts[1][i];
+        if (seen >= rank) {
+            return MIN(latency_hist_bucket_top(i), latency_hist_max(hist));
+        }
+    }
+    return latency_hist_max(hist);
+}
+
+void
+latency_hist_format_header(struct ds *ds)
+{
+    ds_put_format(ds, "%-32s %-10s %-10s %-10s %-10s %-12s %s\n", "",
+                  "window", "p50(us)", "p99(us)", "max(us)", "total",
+                  "max ever(us)");
+}
+
+void
+latency_hist_format(struct ds *ds, const char *name,
+                    const struct latency_hist *hist)
+{
+    ds_put_format(ds, "%-32s %-10u %-10lld %-10lld %-10lld %-12llu %lld\n",
+                  name, latency_hist_count(hist),
+                  latency_hist_percentile(hist, 50),
+                  latency_hist_percentile(hist, 99),
+                  latency_hist_max(hist), hist->n_total, hist->max_total);
+}
@@ -0,0 +1,76 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+struct ds;
+
+/* Latency histogram keeps the distribution of the durations, in usec, of an
+ * operation over a rolling window of its most recent samples.
+ *
+ * Buckets are log-linear: every power of two is split in
+ * 2**LATENCY_HIST_SUB_BITS equal buckets, so that a percentile is reported
+ * within about 6% of the actual value while a histogram stays a fixed size
+ * array of counters, whatever the range of the samples.
+ *
+ * The window is made of two halves of LATENCY_HIST_WINDOW samples each.
+ * Samples go into the current half, and once it is full the previous half is
+ * dropped and the current one takes its place, so percentiles cover the last
+ * LATENCY_HIST_WINDOW to 2 * LATENCY_HIST_WINDOW samples.
+ *
+ * A zero initialized struct latency_hist is an empty histogram.
+ *
+ * Latency Histogram API
+ *
+ * latency_hist_add: adds a sample of 'usec' to the histogram.
+ *
+ * latency_hist_percentile: returns the highest value of the bucket that holds
+ * the percentile 'p' (0 to 100) of the window, or 0 for an empty window.
+ *
+ * latency_hist_format_header, latency_hist_format: format a table with one
+ * row per histogram, with the number of samples, p50, p99 and max of the
+ * window and the all time max.
+ */
+
+#define LATENCY_HIST_SUB_BITS 4
+#define LATENCY_HIST_MAX_BITS 40    /* Samples over 2**40 usec are clamped. */
+#define LATENCY_HIST_N_BUCKETS \
+    ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) \
+     << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_WINDOW 1024
+
+struct latency_hist {
+    uint32_t counts[2][LATENCY_HIST_N_BUCKETS];
+    unsigned int n[2];              /* Samples in each half of the window. */
+    long long int max[2];           /* Highest sample of each half. */
+    int cur;                        /* Half taking new samples. */
+
+    unsigned long long int n_total; /* Samples since startup. */
+    long long int max_total;        /* Highest sample since startup. */
+};
+
+void latency_hist_add(struct latency_hist *, long long int usec);
+unsigned int latency_hist_count(const struct latency_hist *);
+long long int latency_hist_percentile(const struct latency_hist *, double p);
+long long int latency_hist_max(const struct latency_hist *);
+
+void latency_hist_format_header(struct ds *);
+void latency_hist_format(struct ds *, const char *name,
+                         const struct latency_hist *);
+
+#endif /* latency-hist.h */
@@ -29,6 +29,7 @@
 #include "dynamic-string.h"
 #include "openvswitch/vlog.h"
 #include "plugins_yaml.h"
+#include "startup-timeline.h"
 #include "dirs.h"
 #include "ops-dirs.h"
 
@@ -136,8 +137,11 @@ plugins_initializaton(void)
     struct shash_node *sh_node;
     struct plugin_class *plcl;
     const lt_dlinfo *info;
+    size_t phase;
 
+    phase = startup_timeline_begin("plugins yaml");
     plugins_list = get_yaml_plugins();
+    startup_timeline_end(phase);
 
     /* First initialize plugins in the order specified by the yaml
      * configuration file*/
@@ -153,7 +157,11 @@ plugins_initializaton(void)
                         VLOG_DBG("Initializing plugin %s with phase_id %d.",
                                  info->name, h_node->phase_id);
                     }
+                    phase = startup_timeline_begin("plugin %s init (phase %d)",
+                                                   l_node->name,
+                                                   h_node->phase_id);
                     plcl->init(h_node->phase_id);
+                    startup_timeline_end(phase);
                     h_node->phase_id++;
                 } else {
                     VLOG_ERR("No init found for plugin %s.", l_node->name);
@@ -177,7 +185,10 @@ plugins_initializaton(void)
                 if (info) {
                     VLOG_DBG("Initializing plugin %s", info->name);
                 }
+                phase = startup_timeline_begin("plugin %s init",
+                                               sh_node->name);
                 plcl->init(0);
+                startup_timeline_end(phase);
                 h_node->phase_id++;
             }
         }
@@ -18,24 +18,91 @@
 #include <errno.h>
 #include "reconfigure-blocks.h"
 #include "openvswitch/vlog.h"
+#include "callback-stats.h"
+#include "coverage.h"
+#include "latency-hist.h"
 #include "list.h"
+#include "timeval.h"
+#include "openswitch-idl.h"
 #include "vswitch-idl.h"
 
 VLOG_DEFINE_THIS_MODULE(blocks);
 
+COVERAGE_DEFINE(reconfigure_callback_skip);
+
+/* An interest of a callback, with whether its table had rows at the previous
+ * reconfiguration.  The IDL change tracking macros need a row of the table,
+ * so a table whose last row was deleted is detected through 'nonempty'. */
+struct blk_interest {
+    struct reconfigure_interest interest;
+    bool nonempty;
+};
+
 /* Node for a registered callback handler in a reconfigure block list */
 struct blk_list_node{
     void (*callback_handler)(struct blk_params*);
     unsigned int priority;
+    struct callback_stats *stats;
+
+    /* Interests of the callback.  Without any, it always runs. */
+    struct blk_interest *interests;
+    size_t n_interests;
+    unsigned int interest_generation;   /* When 'interest_changed' was set. */
+    bool interest_changed;
+
     struct ovs_list node;
 };
 
+/* Every IDL row starts with its generic row, so this lets the change tracking
+ * macros work on the rows of any table. */
+struct blk_interest_row {
+    struct ovsdb_idl_row header_;
+};
+
+/* A reconfiguration is told apart from the previous one by its 'idl_seqno'.
+ * 'interest_generation' counts the reconfigurations, so that the interests of
+ * each callback are evaluated once per reconfiguration, whatever the number
+ * of bridges, VRFs and ports it is called for. */
+static bool interest_seqno_valid = false;
+static unsigned int interest_seqno;
+static unsigned int interest_generation;
+
+/* Run every callback in the current reconfiguration, and in the next one if
+ * 'force_all_pending'. */
+static bool force_all = false;
+static bool force_all_pending = true;
+
 static bool blocks_init = false;
 static struct ovs_list** blk_list = NULL;
 
+/* IDL the column interests are tracked on.  Known once BLK_BRIDGE_INIT ran,
+ * which is after the plugins registered their callbacks. */
+static struct ovsdb_idl *interest_idl = NULL;
+
+static const char *blk_names[MAX_BLOCKS_NUM] = {
+    [BLK_BRIDGE_INIT] = "BLK_BRIDGE_INIT",
+    [BLK_INIT_RECONFIGURE] = "BLK_INIT_RECONFIGURE",
+    [BLK_BR_DELETE_PORTS] = "BLK_BR_DELETE_PORTS",
+    [BLK_VRF_DELETE_PORTS] = "BLK_VRF_DELETE_PORTS",
+    [BLK_BR_RECONFIGURE_PORTS] = "BLK_BR_RECONFIGURE_PORTS",
+    [BLK_VRF_RECONFIGURE_PORTS] = "BLK_VRF_RECONFIGURE_PORTS",
+    [BLK_BR_ADD_PORTS] = "BLK_BR_ADD_PORTS",
+    [BLK_VRF_ADD_PORTS] = "BLK_VRF_ADD_PORTS",
+    [BLK_BR_PORT_UPDATE] = "BLK_BR_PORT_UPDATE",
+    [BLK_BR_FEATURE_RECONFIG] = "BLK_BR_FEATURE_RECONFIG",
+    [BLK_VRF_PORT_UPDATE] = "BLK_VRF_PORT_UPDATE",
+    [BLK_VRF_ADD_NEIGHBORS] = "BLK_VRF_ADD_NEIGHBORS",
+    [BLK_RECONFIGURE_NEIGHBORS] = "BLK_RECONFIGURE_NEIGHBORS",
+};
+
+/* Duration of each execution of a block, all its callbacks included. */
+static struct latency_hist blk_latency[MAX_BLOCKS_NUM];
+
 static int init_reconfigure_blocks(void);
 static int insert_node_on_blk(struct blk_list_node *new_node,
                                struct ovs_list *func_list);
+static void blk_node_track(const struct blk_list_node *node,
+                           struct ovsdb_idl *idl);
 
 /* Register a callback function for the given reconfigure block with a given priority.
  * Callbacks are executed in ascending order of priority 0 for maximum priority and
@@ -44,8 +111,24 @@ static int insert_node_on_blk(struct blk_list_node *new_node,
 int
 register_reconfigure_callback(void (*callback_handler)(struct blk_params*),
                            enum block_id blk_id, unsigned int priority)
+{
+    return register_reconfigure_callback_with_interest(callback_handler,
+                                                       blk_id, priority,
+                                                       NULL, 0);
+}
+
+/* Same as register_reconfigure_callback(), except that the callback is only
+ * called in the reconfigurations where one of the 'n_interests' tables or
+ * columns in 'interests' changed.
+ */
+int
+register_reconfigure_callback_with_interest(
+    void (*callback_handler)(struct blk_params*),
+    enum block_id blk_id, unsigned int priority,
+    const struct reconfigure_interest *interests, size_t n_interests)
 {
     struct blk_list_node *new_node;
+    size_t i;
 
     /* Initialize reconfigure lists */
     if (!blocks_init) {
@@ -65,14 +148,35 @@ register_reconfigure_callback(void (*callback_handler)(struct blk_params*),
         goto error;
     }
 
-    new_node = (struct blk_list_node *) xmalloc (sizeof(struct blk_list_node));
+    for (i = 0; i < n_interests; i++) {
+        if (!interests[i].table) {
+            VLOG_ERR("NULL table in callback interests");
+            goto error;
+        }
+    }
+
+    new_node = (struct blk_list_node *) xzalloc (sizeof(struct blk_list_node));
     new_node->callback_handler = callback_handler;
     new_node->priority = priority;
+    if (n_interests) {
+        new_node->interests = xcalloc(n_interests,
+                                      sizeof *new_node->interests);
+        for (i = 0; i < n_interests; i++) {
+            new_node->interests[i].interest = interests[i];
+        }
+        new_node->n_interests = n_interests;
+    }
     if (insert_node_on_blk(new_node, blk_list[blk_id])) {
         VLOG_ERR("Failed to add node in block");
+        free(new_node->interests);
         free(new_node);
         goto error;
     }
+    new_node->stats = callback_stats_create("reconfigure", blk_names[blk_id],
+                                            (void (*)(void)) callback_handler);
+    if (interest_idl) {
+        blk_node_track(new_node, interest_idl);
+    }
     return 0;
 
 error:
@@ -141,6 +245,98 @@ init_reconfigure_blocks(void)
     return 0;
 }
 
+/* Enables the change tracking of the column interests of 'node' on 'idl',
+ * which OVSREC_IDL_IS_COLUMN_MODIFIED() relies on. */
+static void
+blk_node_track(const struct blk_list_node *node, struct ovsdb_idl *idl)
+{
+    size_t i;
+
+    for (i = 0; i < node->n_interests; i++) {
+        if (node->interests[i].interest.column) {
+            ovsdb_idl_track_add_column(idl,
+                                       node->interests[i].interest.column);
+        }
+    }
+}
+
+/* Enables the change tracking of the column interests of every callback
+ * registered so far on 'idl'. */
+static void
+blk_track_all(struct ovsdb_idl *idl)
+{
+    struct blk_list_node *node;
+    int i;
+
+    for (i = 0; i < MAX_BLOCKS_NUM; i++) {
+        LIST_FOR_EACH (node, node, blk_list[i]) {
+            blk_node_track(node, idl);
+        }
+    }
+}
+
+/* Returns true if the table or column of 'bi' changed since 'idl_seqno'. */
+static bool
+blk_interest_changed(struct blk_interest *bi, struct ovsdb_idl *idl,
+                     unsigned int idl_seqno)
+{
+    const struct reconfigure_interest *interest = &bi->interest;
+    const struct blk_interest_row *first;
+    bool changed;
+
+    first = (const struct blk_interest_row *)
+            ovsdb_idl_first_row(idl, interest->table);
+    if (interest->column) {
+        changed = OVSREC_IDL_IS_COLUMN_MODIFIED(*interest->column, idl_seqno);
+    } else {
+        changed = first
+                  && (OVSREC_IDL_ANY_TABLE_ROWS_INSERTED(first, idl_seqno)
+                      || OVSREC_IDL_ANY_TABLE_ROWS_MODIFIED(first, idl_seqno)
+                      || OVSREC_IDL_ANY_TABLE_ROWS_DELETED(first, idl_seqno));
+    }
+
+    /* The table gaining its first row or losing its last one changes the
+     * column as well. */
+    changed = changed || bi->nonempty != (first != NULL);
+    bi->nonempty = first != NULL;
+    return changed;
+}
+
+/* Returns true if the callback of 'node' has to run in the reconfiguration
+ * described by 'params'. */
+static bool
+blk_node_is_interested(struct blk_list_node *node,
+                       const struct blk_params *params)
+{
+    size_t i;
+
+    if (!node->n_interests) {
+        return true;
+    }
+
+    if (node->interest_generation != interest_generation) {
+        node->interest_generation = interest_generation;
+
+        /* Every interest is evaluated to keep its 'nonempty' current. */
+        node->interest_changed = force_all;
+        for (i = 0; i < node->n_interests; i++) {
+            if (blk_interest_changed(&node->interests[i], params->idl,
+                                     params->idl_seqno)) {
+                node->interest_changed = true;
+            }
+        }
+    }
+    return node->interest_changed;
+}
+
+/* Makes the next reconfiguration call every callback, whatever their
+ * interests. */
+void
+reconfigure_blocks_force_all(void)
+{
+    force_all_pending = true;
+}
+
 /* Execute all registered callbacks for a given Reconfigure Block ordered by
  * priority
 */
@@ -148,6 +344,8 @@ int
 execute_reconfigure_block(struct blk_params *params, enum block_id blk_id)
 {
     struct blk_list_node *actual_node;
+    long long int start, cb_start;
+    bool filter;
 
     /* Initialize reconfigure lists */
     if (!blocks_init) {
@@ -169,16 +367,55 @@ execute_reconfigure_block(struct blk_params *params, enum block_id blk_id)
 
     VLOG_DBG("Executing block %d of bridge reconfigure", blk_id);
 
+    if (blk_id == BLK_BRIDGE_INIT && params->idl && !interest_idl) {
+        interest_idl = params->idl;
+        blk_track_all(interest_idl);
+    }
+
+    /* BLK_BRIDGE_INIT runs before the first reconfiguration and is not
+     * filtered. */
+    filter = blk_id != BLK_BRIDGE_INIT && params->idl;
+    if (filter && (!interest_seqno_valid
+                   || params->idl_seqno != interest_seqno)) {
+        interest_seqno_valid = true;
+        interest_seqno = params->idl_seqno;
+        interest_generation++;
+        force_all = force_all_pending;
+        force_all_pending = false;
+    }
+
+    start = time_usec();
     LIST_FOR_EACH(actual_node, node, blk_list[blk_id]) {
         if (!actual_node->callback_handler) {
             VLOG_ERR("Invalid function callback_handler found");
             goto error;
         }
+        if (filter && !blk_node_is_interested(actual_node, params)) {
+            COVERAGE_INC(reconfigure_callback_skip);
+            continue;
+        }
+        cb_start = time_usec();
         actual_node->callback_handler(params);
+        callback_stats_account(actual_node->stats, cb_start);
     }
+    latency_hist_add(&blk_latency[blk_id], time_usec() - start);
 
     return 0;
 
  error:
     return EINVAL;
 }
+
+/* Returns the name of the block 'blk_id'. */
+const char *
+reconfigure_block_name(enum block_id blk_id)
+{
+    return blk_names[blk_id];
+}
+
+/* Returns the histogram of the execution time of the block 'blk_id'. */
+const struct latency_hist *
+reconfigure_block_latency(enum block_id blk_id)
+{
+    return &blk_latency[blk_id];
+}
@@ -79,13 +79,32 @@
  * in a block in an ascending order (NO_PRIORITY can be used when ordering is not important
  * or needed).
  *
+ * register_reconfigure_callback_with_interest: same as
+ * register_reconfigure_callback, but the callback is skipped in the
+ * reconfigurations where none of the given tables or columns changed since
+ * the previous one.  A table interest covers any row inserted, modified or
+ * deleted in the table, a column interest any modification of the column.
+ * Change tracking is enabled on the IDL for every column interest.
+ * BLK_BRIDGE_INIT callbacks always run.
+ *
+ * reconfigure_blocks_force_all: makes the next reconfiguration call every
+ * callback, whatever their interests.  Called by SwitchD when it rebuilds its
+ * state regardless of the database changes.
+ *
  * execute_reconfigure_block: executes all registered callbacks on the given
  * block_id with the given block parameters.
+ *
+ * reconfigure_block_latency: returns the histogram of the duration of every
+ * execution of a block, all its callbacks included.
  */
 
 
 #define NO_PRIORITY  UINT_MAX
 
+struct latency_hist;
+struct ovsdb_idl_column;
+struct ovsdb_idl_table_class;
+
 enum block_id {
     BLK_BRIDGE_INIT = 0,
     BLK_INIT_RECONFIGURE,
@@ -124,8 +143,21 @@ struct blk_params{
     struct hmap *all_vrfs;    /* Map containing all vrf instances*/
 };
 
+/* A table, or a column of it, that a reconfigure callback depends on. */
+struct reconfigure_interest {
+    const struct ovsdb_idl_table_class *table;
+    const struct ovsdb_idl_column *column;  /* NULL for the whole table. */
+};
+
 int execute_reconfigure_block(struct blk_params *params, enum block_id blk_id);
 int register_reconfigure_callback(void (*callback_handler)(struct blk_params*),
                                   enum block_id blk_id, unsigned int priority);
+int register_reconfigure_callback_with_interest(
+    void (*callback_handler)(struct blk_params*),
+    enum block_id blk_id, unsigned int priority,
+    const struct reconfigure_interest *interests, size_t n_interests);
+void reconfigure_blocks_force_all(void);
+const char *reconfigure_block_name(enum block_id blk_id);
+const struct latency_hist *reconfigure_block_latency(enum block_id blk_id);
 
 #endif /* reconfigure-blocks.h */
@@ -17,7 +17,9 @@
 #include <errno.h>
 #include "run-blocks.h"
 #include "openvswitch/vlog.h"
+#include "callback-stats.h"
 #include "list.h"
+#include "timeval.h"
 #include "vswitch-idl.h"
 
 VLOG_DEFINE_THIS_MODULE(run_blocks);
@@ -26,12 +28,19 @@ VLOG_DEFINE_THIS_MODULE(run_blocks);
 struct run_blk_list_node{
     void (*callback_handler)(struct run_blk_params*);
     unsigned int priority;
+    struct callback_stats *stats;
     struct ovs_list node;
 };
 
 static bool blocks_init = false;
 static struct ovs_list** blk_list = NULL;
 
+static const char *blk_names[MAX_RUN_BLOCKS_NUM] = {
+    [BLK_INIT_RUN] = "BLK_INIT_RUN",
+    [BLK_RUN_COMPLETE] = "BLK_RUN_COMPLETE",
+    [BLK_WAIT_COMPLETE] = "BLK_WAIT_COMPLETE",
+};
+
 static int init_r_blocks(void);
 static int insert_node_on_blk(struct run_blk_list_node *new_node,
                                struct ovs_list *func_list);
@@ -73,6 +82,8 @@ register_run_callback(void (*callback_handler)(struct run_blk_params*),
         free(new_node);
         goto error;
     }
+    new_node->stats = callback_stats_create("run", blk_names[blk_id],
+                                            (void (*)(void)) callback_handler);
     return 0;
 
 error:
@@ -148,6 +159,7 @@ int
 execute_run_block(struct run_blk_params *params, enum run_block_id blk_id)
 {
     struct run_blk_list_node *actual_node;
+    long long int start;
 
     /* Initialize run lists */
     if (!blocks_init) {
@@ -172,7 +184,9 @@ execute_run_block(struct run_blk_params *params, enum run_block_id blk_id)
             VLOG_ERR("Invalid function callback_handler found");
             goto error;
         }
+        start = time_usec();
         actual_node->callback_handler(params);
+        callback_stats_account(actual_node->stats, start);
     }
 
     return 0;
@@ -0,0 +1,198 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include "startup-timeline.h"
+#include "dynamic-string.h"
+#include "timeval.h"
+#include "unixctl.h"
+#include "openvswitch/vlog.h"
+#include "util.h"
+
+VLOG_DEFINE_THIS_MODULE(startup_timeline);
+
+struct startup_phase {
+    char *name;
+    int depth;                  /* Number of enclosing phases. */
+    long long int start;        /* usec since 'timeline_origin'. */
+    long long int end;          /* LLONG_MIN while the phase is running. */
+};
+
+static struct startup_phase *phases;
+static size_t n_phases, allocated_phases;
+
+static long long int timeline_origin;
+static int timeline_depth;
+static bool timeline_complete;
+
+static unixctl_cb_func startup_timeline_unixctl_show;
+
+void
+startup_timeline_init(void)
+{
+    timeline_origin = time_usec();
+    unixctl_command_register("switchd/startup-timeline", "", 0, 0,
+                             startup_timeline_unixctl_show, NULL);
+}
+
+static long long int
+startup_timeline_now(void)
+{
+    return time_usec() - timeline_origin;
+}
+
+static struct startup_phase *
+startup_phase_add(char *name)
+{
+    struct startup_phase *phase;
+
+    if (n_phases >= allocated_phases) {
+        phases = x2nrealloc(phases, &allocated_phases, sizeof *phases);
+    }
+    phase = &phases[n_phases++];
+    phase->name = name;
+    phase->depth = timeline_depth;
+    phase->start = startup_timeline_now();
+    phase->end = LLONG_MIN;
+    return phase;
+}
+
+size_t
+startup_timeline_begin(const char *format, ...)
+{
+    va_list args;
+    char *name;
+
+    if (timeline_complete) {
+        return SIZE_MAX;
+    }
+
+    va_start(args, format);
+    name = xvasprintf(format, args);
+    va_end(args);
+
+    startup_phase_add(name);
+    timeline_depth++;
+    return n_phases - 1;
+}
+
+void
+startup_timeline_end(size_t id)
+{
+    if (id >= n_phases || phases[id].end != LLONG_MIN) {
+        return;
+    }
+    phases[id].end = startup_timeline_now();
+    timeline_depth--;
+}
+
+void
+startup_timeline_mark(const char *name)
+{
+    struct startup_phase *phase;
+    size_t i;
+
+    if (timeline_complete) {
+        return;
+    }
+
+    for (i = 0; i < n_phases; i++) {
+        if (!strcmp(phases[i].name, name)) {
+            return;
+        }
+    }
+    phase = startup_phase_add(xstrdup(name));
+    phase->end = phase->start;
+}
+
+static long long int
+startup_phase_duration(const struct startup_phase *phase)
+{
+    return (phase->end != LLONG_MIN ? phase->end : startup_timeline_now())
+           - phase->start;
+}
+
+void
+startup_timeline_complete(void)
+{
+    struct ds s = DS_EMPTY_INITIALIZER;
+    size_t i;
+
+    if (timeline_complete) {
+        return;
+    }
+    timeline_complete = true;
+
+    for (i = 0; i < n_phases; i++) {
+        const struct startup_phase *phase = &phases[i];
+
+        if (phase->depth) {
+            continue;
+        }
+        if (phase->end == phase->start) {
+            ds_put_format(&s, "%s at %lld ms, ", phase->name,
+                          phase->start / 1000);
+        } else {
+            ds_put_format(&s, "%s %lld ms, ", phase->name,
+                          startup_phase_duration(phase) / 1000);
+        }
+    }
+    VLOG_INFO("startup timeline: %sconverged after %lld ms",
+              ds_cstr(&s), startup_timeline_now() / 1000);
+    ds_destroy(&s);
+}
+
+bool
+startup_timeline_is_complete(void)
+{
+    return timeline_complete;
+}
+
+static void
+startup_timeline_unixctl_show(struct unixctl_conn *conn,
+                              int argc OVS_UNUSED,
+                              const char *argv[] OVS_UNUSED,
+                              void *aux OVS_UNUSED)
+{
+    struct ds reply = DS_EMPTY_INITIALIZER;
+    size_t i;
+
+    ds_put_format(&reply, "%-48s %12s %12s\n",
+                  "phase", "start (ms)", "time (ms)");
+    for (i = 0; i < n_phases; i++) {
+        const struct startup_phase *phase = &phases[i];
+        int width = 48 - 2 * phase->depth;
+
+        ds_put_format(&reply, "%*s%-*s %12.3f", 2 * phase->depth, "",
+                      width > 0 ? width : 0, phase->name,
+                      phase->start / 1000.0);
+        if (phase->end == phase->start) {
+            ds_put_format(&reply, " %12s\n", "-");
+        } else {
+            ds_put_format(&reply, " %12.3f%s\n",
+                          startup_phase_duration(phase) / 1000.0,
+                          phase->end == LLONG_MIN ? " (running)" : "");
+        }
+    }
+    if (!timeline_complete) {
+        ds_put_cstr(&reply, "startup not converged yet\n");
+    }
+    unixctl_command_reply(conn, ds_cstr(&reply));
+    ds_destroy(&reply);
+}
@@ -0,0 +1,58 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "compiler.h"
+
+/* Startup timeline records when each phase of the SwitchD startup begins and
+ * ends, on the monotonic clock, from the start of main() until the first full
+ * convergence: initial configuration committed and first statistics
+ * published.
+ *
+ * Phases may nest (e.g. the init() of every plugin within plugins_init()),
+ * and point events (e.g. daemonize completion) are recorded as phases of
+ * zero duration.  Once the timeline is complete, a one-line summary of the
+ * top level phases is logged and further records are ignored.
+ *
+ * The timeline is shown by the "switchd/startup-timeline" unixctl command.
+ *
+ * Startup Timeline API
+ *
+ * startup_timeline_init: sets the origin of the timeline and registers the
+ * unixctl command.  Called first thing in main().
+ *
+ * startup_timeline_begin: starts a phase named after 'format' and returns an
+ * id for startup_timeline_end().
+ *
+ * startup_timeline_end: ends the phase 'id'.
+ *
+ * startup_timeline_mark: records the point event 'name'.  Only the first
+ * occurrence of an event is recorded.
+ *
+ * startup_timeline_complete: closes the timeline and logs its summary.
+ */
+
+void startup_timeline_init(void);
+size_t startup_timeline_begin(const char *format, ...) OVS_PRINTF_FORMAT(1, 2);
+void startup_timeline_end(size_t id);
+void startup_timeline_mark(const char *name);
+void startup_timeline_complete(void);
+bool startup_timeline_is_complete(void);
+
+#endif /* startup-timeline.h */
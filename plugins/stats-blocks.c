@@ -17,8 +17,10 @@
 #include "stats-blocks.h"
 #include <stdlib.h>
 #include <errno.h>
+#include "callback-stats.h"
 #include "list.h"
 #include "openvswitch/vlog.h"
+#include "timeval.h"
 #include "vswitch-idl.h"
 
 VLOG_DEFINE_THIS_MODULE(stats_blocks);
@@ -27,12 +29,30 @@ VLOG_DEFINE_THIS_MODULE(stats_blocks);
 struct stats_blk_list_node{
     void (*callback_handler)(struct stats_blk_params *, enum stats_block_id);
     unsigned int priority;
+    struct callback_stats *stats;
     struct ovs_list node;
 };
 
 static bool blocks_init = false;
 static struct ovs_list** blk_list = NULL;
 
+static const char *blk_names[MAX_STATS_BLOCKS_NUM] = {
+    [STATS_BRIDGE_CREATE_NETDEV] = "STATS_BRIDGE_CREATE_NETDEV",
+    [STATS_BEGIN] = "STATS_BEGIN",
+    [STATS_PER_BRIDGE] = "STATS_PER_BRIDGE",
+    [STATS_PER_BRIDGE_PORT] = "STATS_PER_BRIDGE_PORT",
+    [STATS_PER_BRIDGE_NETDEV] = "STATS_PER_BRIDGE_NETDEV",
+    [STATS_PER_VRF] = "STATS_PER_VRF",
+    [STATS_PER_VRF_PORT] = "STATS_PER_VRF_PORT",
+    [STATS_PER_VRF_NETDEV] = "STATS_PER_VRF_NETDEV",
+    [STATS_END] = "STATS_END",
+    [STATS_SUBSYSTEM_CREATE_NETDEV] = "STATS_SUBSYSTEM_CREATE_NETDEV",
+    [STATS_SUBSYSTEM_BEGIN] = "STATS_SUBSYSTEM_BEGIN",
+    [STATS_PER_SUBSYSTEM] = "STATS_PER_SUBSYSTEM",
+    [STATS_PER_SUBSYSTEM_NETDEV] = "STATS_PER_SUBSYSTEM_NETDEV",
+    [STATS_SUBSYSTEM_END] = "STATS_SUBSYSTEM_END",
+};
+
 static int init_s_blocks(void);
 static int insert_node_on_blk(struct stats_blk_list_node *new_node,
                               struct ovs_list *func_list);
@@ -75,6 +95,8 @@ register_stats_callback(void (*callback_handler)(struct stats_blk_params *,
         free(new_node);
         goto error;
     }
+    new_node->stats = callback_stats_create("stats", blk_names[blk_id],
+                                            (void (*)(void)) callback_handler);
     return 0;
 
 error:
@@ -150,6 +172,7 @@ int
 execute_stats_block(struct stats_blk_params *sblk, enum stats_block_id blk_id)
 {
     struct stats_blk_list_node *actual_node;
+    long long int start;
 
     /* Initialize stats lists */
     if (!blocks_init) {
@@ -169,7 +192,9 @@ execute_stats_block(struct stats_blk_params *sblk, enum stats_block_id blk_id)
             VLOG_ERR("Invalid function callback_handler found");
             goto error;
         }
+        start = time_usec();
         actual_node->callback_handler(sblk, blk_id);
+        callback_stats_account(actual_node->stats, start);
     }
 
     return 0;
@@ -17,6 +17,8 @@
 #ifndef STATS_BLOCKS_H
 #define STATS_BLOCKS_H
 
+#include <stdbool.h>
+
 /* Stats Blocks allow an external SwitchD plugin to register callback handlers
  * to be triggered in the bridge statistics-gathering path. This enables the
  * external plugin to
@@ -75,6 +77,19 @@ enum stats_block_id {
     MAX_STATS_BLOCKS_NUM,
 };
 
+/* Smoothed interface rates computed by switchd each time the interface
+ * statistics are collected.  Utilization is relative to the interface
+ * link_speed and is 0 when the link speed is unknown. */
+struct iface_rates {
+    double rx_pps;            /* Received packets per second. */
+    double tx_pps;            /* Transmitted packets per second. */
+    double rx_bps;            /* Received bits per second. */
+    double tx_bps;            /* Transmitted bits per second. */
+    double rx_util;           /* Receive utilization, in percent. */
+    double tx_util;           /* Transmit utilization, in percent. */
+    bool valid;               /* False until two samples have been taken. */
+};
+
 struct stats_blk_params {
     unsigned int idl_seqno;   /* Current transaction's sequence number */
     struct ovsdb_idl *idl;    /* OVSDB IDL */
@@ -88,6 +103,9 @@ struct stats_blk_params {
                                  blocks parsing iface instances */
     const struct ovsrec_interface *cfg; /* Reference to current iface's OVSDB record.
                                            Only valid for blocks parsing iface instances */
+    const struct iface_rates *rates; /* Smoothed rates of current iface.
+                                        Only valid for blocks parsing iface
+                                        instances */
 };
 
 /*
@@ -117,18 +135,18 @@ int register_stats_callback(void (*callback_handler)(struct stats_blk_params *sb
  *  STATS_PER_BRIDGE        current bridge (struct bridge *), idl_seqno, IDL
  *  STATS_PER_BRIDGE_PORT   current port (struct port *), bridge, idl_seqno, IDL
  *  STATS_PER_BRIDGE_NETDEV current interface's underlying netdev (struct netdev *),
- *                              port, bridge, idl_seqno, IDL
+ *                              rates, port, bridge, idl_seqno, IDL
  *  STATS_PER_VRF           current VRF (struct vrf *), idl_seqno, IDL
  *  STATS_PER_VRF_PORT      current port (struct port *), vrf, idl_seqno, IDL
  *  STATS_PER_VRF_NETDEV    current interface's underlying netdev (struct netdev *),
- *                              port, vrf, idl_seqno, IDL
+ *                              rates, port, vrf, idl_seqno, IDL
  *  STATS_END               IDL, idl_seqno
  *  STATS_CREATE_NETDEV     IDL, idl_seqno, netdev
  *
  * from subsystem.c:
  *  STATS_SUBSYSTEM_BEGIN           IDL, idl_seqno
  *  STATS_PER_SUBSYSTEM             IDL, idl_seqno
- *  STATS_PER_SUBSYSTEM_NETDEV      IDL, idl_seqno, netdev
+ *  STATS_PER_SUBSYSTEM_NETDEV      IDL, idl_seqno, netdev, rates
  *  STATS_SUBSYSTEM_END             IDL, idl_seqno
  *  STATS_SUBSYSTEM_CREATE_NETDEV   IDL, idl_seqno, netdev
  */
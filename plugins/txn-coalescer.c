@@ -0,0 +1,182 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "txn-coalescer.h"
+#include "coverage.h"
+#include "openvswitch/vlog.h"
+#include "util.h"
+
+VLOG_DEFINE_THIS_MODULE(txn_coalescer);
+
+COVERAGE_DEFINE(txn_coalescer_commit);
+COVERAGE_DEFINE(txn_coalescer_write);
+
+/* A coalesced transaction whose commit has not completed yet. */
+struct txn_batch {
+    struct ovsdb_idl_txn *txn;
+    struct txn_writer **writers;    /* Writers carried by 'txn'. */
+    size_t n_writers;
+    struct ovs_list node;           /* In 'in_flight_batches'. */
+};
+
+static struct ovsdb_idl *coalescer_idl = NULL;
+
+/* Writers requested during the current iteration, in request order. */
+static struct ovs_list pending_writers = OVS_LIST_INITIALIZER(&pending_writers);
+
+/* Batches waiting for their commit to complete. */
+static struct ovs_list in_flight_batches
+    = OVS_LIST_INITIALIZER(&in_flight_batches);
+
+void
+txn_coalescer_init(struct ovsdb_idl *idl)
+{
+    coalescer_idl = idl;
+}
+
+void
+txn_writer_request(struct txn_writer *writer)
+{
+    if (!writer->pending) {
+        writer->pending = true;
+        list_push_back(&pending_writers, &writer->node);
+    }
+}
+
+bool
+txn_writer_is_busy(const struct txn_writer *writer)
+{
+    return writer->pending || writer->n_in_flight;
+}
+
+/* Reports the final 'status' of the commit of 'batch' to its writers and
+ * frees it. */
+static void
+txn_batch_finish(struct txn_batch *batch, enum ovsdb_idl_txn_status status)
+{
+    size_t i;
+
+    if (status != TXN_SUCCESS && status != TXN_UNCHANGED) {
+        VLOG_DBG("coalesced transaction of %"PRIuSIZE" writers: %s",
+                 batch->n_writers, ovsdb_idl_txn_status_to_string(status));
+    }
+
+    for (i = 0; i < batch->n_writers; i++) {
+        struct txn_writer *writer = batch->writers[i];
+
+        writer->n_in_flight--;
+        if (writer->done) {
+            writer->done(status, writer->aux);
+        }
+    }
+
+    ovsdb_idl_txn_destroy(batch->txn);
+    free(batch->writers);
+    free(batch);
+}
+
+/* Creates a transaction, writes the 'n_writers' writers of 'writers' into it
+ * and commits it.  Takes ownership of 'writers'. */
+static void
+txn_batch_commit(struct txn_writer **writers, size_t n_writers)
+{
+    struct txn_batch *batch;
+    enum ovsdb_idl_txn_status status;
+    size_t i;
+
+    batch = xmalloc(sizeof *batch);
+    batch->writers = writers;
+    batch->n_writers = n_writers;
+    batch->txn = ovsdb_idl_txn_create(coalescer_idl);
+
+    for (i = 0; i < n_writers; i++) {
+        writers[i]->n_in_flight++;
+        writers[i]->write(batch->txn, writers[i]->aux);
+    }
+    COVERAGE_INC(txn_coalescer_commit);
+    COVERAGE_ADD(txn_coalescer_write, n_writers);
+
+    status = ovsdb_idl_txn_commit(batch->txn);
+    if (status == TXN_INCOMPLETE) {
+        list_push_back(&in_flight_batches, &batch->node);
+    } else {
+        txn_batch_finish(batch, status);
+    }
+}
+
+/* Finishes the batches whose commit completed, then writes and commits every
+ * pending writer in a single transaction.  Isolated writers get one each. */
+void
+txn_coalescer_run(void)
+{
+    struct txn_batch *batch, *next;
+    struct txn_writer **shared, **isolated;
+    size_t n_shared, n_isolated, n, i;
+
+    LIST_FOR_EACH_SAFE (batch, next, node, &in_flight_batches) {
+        enum ovsdb_idl_txn_status status;
+
+        status = ovsdb_idl_txn_commit(batch->txn);
+        if (status != TXN_INCOMPLETE) {
+            list_remove(&batch->node);
+            txn_batch_finish(batch, status);
+        }
+    }
+
+    if (list_is_empty(&pending_writers)) {
+        return;
+    }
+    ovs_assert(coalescer_idl);
+
+    /* Take every pending writer before calling any 'write' callback, so that
+     * a writer requested again from one waits for the next iteration. */
+    n = list_size(&pending_writers);
+    shared = xmalloc(n * sizeof *shared);
+    isolated = xmalloc(n * sizeof *isolated);
+    n_shared = n_isolated = 0;
+    while (!list_is_empty(&pending_writers)) {
+        struct txn_writer *writer;
+
+        writer = CONTAINER_OF(list_pop_front(&pending_writers),
+                              struct txn_writer, node);
+        writer->pending = false;
+        if (writer->isolated) {
+            isolated[n_isolated++] = writer;
+        } else {
+            shared[n_shared++] = writer;
+        }
+    }
+
+    if (n_shared) {
+        txn_batch_commit(shared, n_shared);
+    } else {
+        free(shared);
+    }
+    for (i = 0; i < n_isolated; i++) {
+        txn_batch_commit(xmemdup(&isolated[i], sizeof isolated[i]), 1);
+    }
+    free(isolated);
+}
+
+void
+txn_coalescer_wait(void)
+{
+    struct txn_batch *batch;
+
+    LIST_FOR_EACH (batch, node, &in_flight_batches) {
+        ovsdb_idl_txn_wait(batch->txn);
+    }
+}
@@ -0,0 +1,100 @@
+/* Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TXN_COALESCER_H
+#define TXN_COALESCER_H
+
+#include <stdbool.h>
+#include "ovsdb-idl.h"
+#include "list.h"
+
+/* Transaction coalescer allows the modules of SwitchD, and the plugins loaded
+ * into it, to share a single OVSDB transaction per main loop iteration for
+ * their periodic status and statistics writes, instead of each one creating
+ * and committing its own.
+ *
+ * Since the IDL only allows one open transaction at a time, writes are
+ * deferred rather than appended to an open transaction: during its run a
+ * module only calls txn_writer_request() on its writer, and at the end of the
+ * iteration txn_coalescer_run() creates one transaction, calls the 'write'
+ * callback of every requested writer in request order and commits it.
+ *
+ * Once the commit completes, the 'done' callback of each writer it carried is
+ * called with the final status, so that every module keeps its own retry
+ * policy.  A writer that is pending or whose previous write is still in
+ * flight is reported as busy by txn_writer_is_busy(), which modules that rate
+ * limit their updates use instead of checking their own transaction.
+ *
+ * A writer whose writes may fail for reasons of its own, typically because it
+ * verifies columns, is marked 'isolated' and committed in a transaction of its
+ * own, so that a conflict on its rows does not fail the writes of the others.
+ *
+ * Rows seen by a module during its run remain valid in the 'write' callback
+ * of a writer it requested then, because the requested writes are flushed in
+ * the same iteration, before the IDL runs again.  This does not hold for a
+ * writer requested from a 'write' callback: it is only written in the next
+ * iteration, after the IDL ran, so it must not keep row pointers across and
+ * has to look its rows up again.
+ *
+ * Transaction Coalescer API
+ *
+ * txn_coalescer_init: sets the IDL the coalesced transactions are created on.
+ *
+ * txn_writer_request: schedules the writes of 'writer' for the end of the
+ * current iteration.  Requesting an already pending writer is a no-op.
+ *
+ * txn_coalescer_run: called once per main loop iteration, after every module
+ * ran.  Finishes the transactions that completed and commits the pending
+ * writes.
+ *
+ * txn_coalescer_wait: waits for the transactions still in flight.
+ */
+
+struct txn_writer {
+    const char *name;
+
+    /* Writes to the IDL rows within 'txn', the coalesced transaction. */
+    void (*write)(struct ovsdb_idl_txn *txn, void *aux);
+
+    /* Called once the transaction carrying the writes completes.  May be
+     * NULL if the writer does not care about the outcome. */
+    void (*done)(enum ovsdb_idl_txn_status, void *aux);
+
+    void *aux;
+
+    /* Commit the writes in a transaction of their own. */
+    bool isolated;
+
+    /* Private to the coalescer. */
+    bool pending;               /* In 'pending_writers'. */
+    unsigned int n_in_flight;   /* Number of uncompleted commits carrying it. */
+    struct ovs_list node;       /* In 'pending_writers'. */
+};
+
+#define TXN_WRITER_INITIALIZER(NAME, WRITE, DONE, AUX)  \
+    { .name = (NAME), .write = (WRITE), .done = (DONE), .aux = (AUX) }
+
+#define TXN_WRITER_ISOLATED_INITIALIZER(NAME, WRITE, DONE, AUX)         \
+    { .name = (NAME), .write = (WRITE), .done = (DONE), .aux = (AUX),   \
+      .isolated = true }
+
+void txn_coalescer_init(struct ovsdb_idl *idl);
+void txn_coalescer_run(void);
+void txn_coalescer_wait(void);
+
+void txn_writer_request(struct txn_writer *writer);
+bool txn_writer_is_busy(const struct txn_writer *writer);
+
+#endif /* txn-coalescer.h */
@@ -47,6 +47,7 @@
 #include "ofproto/bond.h"
 #include "ofproto/ofproto.h"
 #include "ovs-numa.h"
+#include "ovs-thread.h"
 #include "poll-loop.h"
 #include "seq.h"
 #include "sha1.h"
@@ -77,11 +78,34 @@
 #include "run-blocks.h"
 #include "plugins.h"
 #include "stats-blocks.h"
+#include "iface-rate.h"
+#include "sflow-governor.h"
+#include "subsystem.h"
+#include "stats-class.h"
+#include "txn-coalescer.h"
+#include "startup-timeline.h"
+#include "latency-hist.h"
+#include "callback-stats.h"
+#include "plugin-extensions.h"
+#include "asic-plugin.h"
 #endif
 
 VLOG_DEFINE_THIS_MODULE(bridge);
 
 COVERAGE_DEFINE(bridge_reconfigure);
+#ifdef OPS
+COVERAGE_DEFINE(bridge_reconfigure_skip);
+COVERAGE_DEFINE(bridge_vlan_bulk_update);
+COVERAGE_DEFINE(bridge_port_register_skip);
+COVERAGE_DEFINE(bridge_sflow_skip);
+COVERAGE_DEFINE(bridge_sflow_cache_refresh);
+COVERAGE_DEFINE(bridge_subintf_reconfigure);
+COVERAGE_DEFINE(bridge_subintf_unchanged);
+#endif
+#ifdef OPS_TEMP
+COVERAGE_DEFINE(bridge_status_skipped);
+COVERAGE_DEFINE(bridge_status_iface_refresh);
+#endif
 
 struct mirror {
     struct uuid uuid;           /* UUID of this "mirror" record in database. */
@@ -105,6 +129,20 @@ struct port {
 };
 #endif
 
+/* Bundle settings of a port, built from the database by port_prepare() and
+ * pushed to ofproto by port_apply(). */
+struct port_prep {
+    struct ofproto_bundle_settings s;
+    struct bond_settings bond_settings;     /* 's.bond' points here. */
+#ifndef OPS
+    struct lacp_settings lacp_settings;     /* 's.lacp' points here. */
+#endif
+    int miimon_interval;        /* For the interfaces of the port. */
+#ifdef OPS
+    struct ds bundle_key;       /* port_bundle_key() of 's'. */
+#endif
+};
+
 #ifndef OPS_TEMP /* Moved to bridge.h, to access from plugins */
 struct bridge {
     struct hmap_node node;      /* In 'all_bridges'. */
@@ -150,6 +188,18 @@ struct ofproto_mirror_bundle {
 /* All bridges, indexed by name. */
 static struct hmap all_bridges = HMAP_INITIALIZER(&all_bridges);
 
+#ifdef OPS
+/* Ports and interfaces of every bridge and VRF, indexed by name. */
+static struct hmap all_ports_by_name = HMAP_INITIALIZER(&all_ports_by_name);
+static struct hmap all_ifaces_by_name
+    = HMAP_INITIALIZER(&all_ifaces_by_name);
+
+/* Subinterfaces, indexed by the name of the parent interface last applied to
+ * their netdev. */
+static struct hmap subintfs_by_parent
+    = HMAP_INITIALIZER(&subintfs_by_parent);
+#endif
+
 #ifdef OPS
 /* Even though VRF is a separate entity from a user and schema
  * perspective, it's essentially very similar to bridge. It has ports,
@@ -222,31 +272,83 @@ static uint64_t connectivity_seqno = LLONG_MIN;
  *
  * Some information in the database must be kept as up-to-date as possible to
  * allow controllers to respond rapidly to network outages.  Those status are
- * updated via the 'status_txn'.
+ * updated via the 'status_txn', or with OPS by 'status_writer' in the
+ * transaction coalesced at the end of the main loop iteration.
  *
  * We use the global connectivity sequence number to detect the status change.
  * Also, to prevent the status update from sending too much to the database,
  * we check the return status of each update transaction and do not start new
  * update if the previous transaction status is 'TXN_INCOMPLETE'.
  *
- * 'statux_txn' is NULL if there is no ongoing status update.
+ * 'statux_txn' is NULL (with OPS, 'status_writer' is not busy) if there is no
+ * ongoing status update.
  *
  * If the previous database transaction was failed (is not 'TXN_SUCCESS',
  * 'TXN_UNCHANGED' or 'TXN_INCOMPLETE'), 'status_txn_try_again' is set to true,
  * which will cause the main thread wake up soon and retry the status update.
  */
+#ifndef OPS
 static struct ovsdb_idl_txn *status_txn;
+#endif
 static bool status_txn_try_again;
 
 /* When the status update transaction returns 'TXN_INCOMPLETE', should register a
  * timeout in 'STATUS_CHECK_AGAIN_MSEC' to check again. */
 #define STATUS_CHECK_AGAIN_MSEC 100
 
+#ifdef OPS_TEMP
+/* Interfaces whose status is refreshed by bridge.c, that is all interfaces
+ * except synthetic ones and the system and loopback interfaces handled by
+ * subsystem.c.  On a connectivity change only the members of this list whose
+ * netdev change_seq moved are refreshed. */
+static struct ovs_list status_ifaces = OVS_LIST_INITIALIZER(&status_ifaces);
+#endif
+
 /* Each time this timer expires, the bridge fetches interface and mirror
  * statistics and pushes them into the database. */
 static int stats_timer_interval;
 static long long int stats_timer = LLONG_MIN;
 
+/* Statistics are collected in 'stats_n_slices' slices spread evenly across
+ * the interval (other_config:stats-update-slices).  'stats_slice' is the
+ * next slice to collect and 'stats_cycle_start' the time slice 0 last ran. */
+#define STATS_DFLT_SLICES 4
+#define STATS_MAX_SLICES 64
+static int stats_n_slices = 1;
+static int stats_slice;
+static long long int stats_cycle_start;
+
+/* Set when the slices are reset while a slice is in flight, so that its
+ * completion restarts from slice 0 instead of moving past it. */
+static bool stats_slice_reset;
+
+/* Collection time of each statistics slice, for "bridge/stats-slices". */
+struct stats_slice_timing {
+    unsigned int n_ifaces;          /* Interfaces visited by the last run. */
+    long long int last_usec;        /* Duration of the last run. */
+    long long int max_usec;         /* Longest run. */
+    long long int total_usec;       /* Sum of all runs. */
+    unsigned long long int n_runs;  /* Number of runs. */
+};
+static struct stats_slice_timing stats_slice_timings[STATS_MAX_SLICES];
+
+#ifdef OPS
+/* Whether a full statistics cycle was published since startup. */
+static bool stats_published;
+#endif
+
+#ifdef OPS
+/* Interfaces are polled according to their stats_class.  A collection cycle
+ * lasts the interval of 'stats_cycle_class', the fastest class seen during
+ * the previous cycle ('stats_next_class' collects it for the next one), but
+ * never longer than the normal interval.  Bridge wide statistics keep the
+ * normal interval, tracked by 'stats_bridge_due'. */
+static enum stats_class stats_cycle_class = STATS_CLASS_NORMAL;
+static enum stats_class stats_next_class = STATS_CLASS_NORMAL;
+static long long int stats_bridge_due;
+static bool stats_bridge_round;
+#endif
+
 /* In some datapaths, creating and destroying OpenFlow ports can be extremely
  * expensive.  This can cause bridge_reconfigure() to take a long time during
  * which no other work can be done.  To deal with this problem, we limit port
@@ -264,6 +366,7 @@ static void bridge_destroy(struct bridge *);
 static struct bridge *bridge_lookup(const char *name);
 static unixctl_cb_func bridge_unixctl_dump_flows;
 static unixctl_cb_func bridge_unixctl_reconnect;
+static unixctl_cb_func bridge_unixctl_stats_slices;
 static size_t bridge_get_controllers(const struct bridge *br,
                                      struct ovsrec_controller ***controllersp);
 static void bridge_collect_wanted_ports(struct bridge *,
@@ -289,12 +392,15 @@ static void vrf_del_ports(struct vrf *,
 static bool enable_lacp(struct port *port, bool *activep);
 static void bridge_configure_vlans(struct bridge *br);
 static unixctl_cb_func vlan_unixctl_show;
+static unixctl_cb_func bridge_unixctl_reconfigure_stats;
 static void bridge_configure_sflow(struct bridge *,
                                    const struct ovsrec_sflow *cfg,
                                    int *sflow_bridge_number);
 static void sflow_agent_address(const char *intf_name, const char *af,
                                 char *addr);
 static void sflow_ports_disabled(struct sset *ports);
+static void bridge_set_sflow(struct bridge *,
+                             const struct ofproto_sflow_options *);
 static bool is_vlan_up(const char *vid);
 #endif
 static void bridge_configure_datapath_id(struct bridge *);
@@ -332,12 +438,20 @@ static struct port *port_create(struct bridge *, const struct ovsrec_port *);
 static void port_del_ifaces(struct port *);
 static void port_destroy(struct port *);
 static struct port *port_lookup(const struct bridge *, const char *name);
+#ifndef OPS
 static void port_configure(struct port *);
+#endif
+static void port_prepare(struct port *, struct port_prep *);
+static void port_apply(struct port *, const struct port_prep *);
+static void port_prep_destroy(struct port_prep *);
+#ifdef OPS
+static void bridge_forget_bundles(struct bridge *);
+#endif
 #ifndef OPS
 static struct lacp_settings *port_configure_lacp(struct port *,
                                                  struct lacp_settings *);
 #endif
-static void port_configure_bond(struct port *, struct bond_settings *);
+static int port_configure_bond(struct port *, struct bond_settings *);
 #ifndef OPS_TEMP
 static bool port_is_synthetic(const struct port *);
 #endif
@@ -382,6 +496,9 @@ static void iface_refresh_stats(struct iface *);
 static void iface_refresh_netdev_status(struct iface *);
 static void iface_refresh_ofproto_status(struct iface *);
 static bool iface_is_synthetic(const struct iface *);
+#ifdef OPS
+static bool iface_has_bridge_status(const struct iface *);
+#endif
 #ifndef OPS_TEMP
 static ofp_port_t iface_get_requested_ofp_port(
     const struct ovsrec_interface *);
@@ -520,6 +637,10 @@ bridge_init(const char *remote)
     idl = ovsdb_idl_create(remote, &ovsrec_idl_class, true, true);
     idl_seqno = ovsdb_idl_get_seqno(idl);
     ovsdb_idl_set_lock(idl, "ovs_vswitchd");
+#ifdef OPS
+    txn_coalescer_init(idl);
+    callback_stats_init();
+#endif
 
     ovsdb_idl_omit_alert(idl, &ovsrec_open_vswitch_col_cur_cfg);
     ovsdb_idl_omit_alert(idl, &ovsrec_open_vswitch_col_statistics);
@@ -559,6 +680,7 @@ bridge_init(const char *remote)
 #ifdef OPS
     ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_pause);
     ovsdb_idl_omit_alert(idl, &ovsrec_neighbor_col_status);
+    ovsdb_idl_omit_alert(idl, &ovsrec_sflow_col_statistics);
 #endif
     ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_link_resets);
     ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_mac_in_use);
@@ -765,9 +887,13 @@ bridge_init(const char *remote)
                              bridge_unixctl_dump_flows, NULL);
     unixctl_command_register("bridge/reconnect", "[bridge]", 0, 1,
                              bridge_unixctl_reconnect, NULL);
+    unixctl_command_register("bridge/stats-slices", "", 0, 0,
+                             bridge_unixctl_stats_slices, NULL);
 #ifdef OPS
     unixctl_command_register("vlan/show", "[vid]", 0, 1,
                              vlan_unixctl_show, NULL);
+    unixctl_command_register("bridge/reconfigure-stats", "", 0, 0,
+                             bridge_unixctl_reconfigure_stats, NULL);
 #endif
     lacp_init();
     bond_init();
@@ -850,6 +976,657 @@ collect_in_band_managers(const struct ovsrec_open_vswitch *ovs_cfg,
     *n_managersp = n_managers;
 }
 
+#ifdef OPS
+/* Incremental reconfiguration.
+ *
+ * bridge_reconfigure() is made of handlers that each depend on a set of
+ * nodes.  A node stands for one or more database tables and is dirty when
+ * the IDL reports rows of those tables inserted, modified or deleted since
+ * 'idl_seqno'.  Only the handlers with a dirty input run, so that e.g. a
+ * Neighbor change does not walk every bridge port.  The reconfigure blocks
+ * that plugins use to watch their own tables (BLK_INIT_RECONFIGURE,
+ * BLK_BR_FEATURE_RECONFIG and BLK_RECONFIGURE_NEIGHBORS) always run. */
+enum reconfigure_node {
+    RECONFIGURE_NODE_SYSTEM,        /* Open_vSwitch and System rows. */
+    RECONFIGURE_NODE_BRIDGES,       /* Bridge and VRF tables. */
+    RECONFIGURE_NODE_PORTS,         /* Port table. */
+    RECONFIGURE_NODE_IFACES,        /* Interface table. */
+    RECONFIGURE_NODE_VLANS,         /* VLAN table. */
+    RECONFIGURE_NODE_MIRRORS,       /* Mirror table. */
+    RECONFIGURE_NODE_SFLOW,         /* sFlow table. */
+    RECONFIGURE_NODE_NEIGHBORS,     /* Neighbor table. */
+    RECONFIGURE_NODE_ROUTES,        /* Route and Nexthop tables. */
+    RECONFIGURE_N_NODES
+};
+
+#define NODE(NAME) (1u << RECONFIGURE_NODE_##NAME)
+#define RECONFIGURE_ALL_NODES ((1u << RECONFIGURE_N_NODES) - 1)
+
+/* Inputs of the handlers of bridge_reconfigure(). */
+#define HANDLER_SYSTEM    (NODE(SYSTEM))
+#define HANDLER_TOPOLOGY  (NODE(SYSTEM) | NODE(BRIDGES) | NODE(PORTS)      \
+                           | NODE(IFACES))
+#define HANDLER_PORTS     (NODE(BRIDGES) | NODE(PORTS) | NODE(IFACES))
+#define HANDLER_DP_ID     (HANDLER_PORTS | NODE(SYSTEM))
+#define HANDLER_VLANS     (NODE(BRIDGES) | NODE(PORTS) | NODE(VLANS))
+#define HANDLER_MIRRORS   (NODE(BRIDGES) | NODE(PORTS) | NODE(MIRRORS))
+#define HANDLER_SFLOW     (HANDLER_PORTS | NODE(SYSTEM) | NODE(SFLOW))
+#define HANDLER_BRIDGE    (NODE(SYSTEM) | NODE(BRIDGES))
+#define HANDLER_NEIGHBORS (NODE(NEIGHBORS))
+#define HANDLER_ROUTES    (NODE(SYSTEM) | NODE(BRIDGES) | NODE(PORTS)      \
+                           | NODE(ROUTES))
+
+static const char *reconfigure_node_names[RECONFIGURE_N_NODES] = {
+    [RECONFIGURE_NODE_SYSTEM] = "system",
+    [RECONFIGURE_NODE_BRIDGES] = "bridges",
+    [RECONFIGURE_NODE_PORTS] = "ports",
+    [RECONFIGURE_NODE_IFACES] = "ifaces",
+    [RECONFIGURE_NODE_VLANS] = "vlans",
+    [RECONFIGURE_NODE_MIRRORS] = "mirrors",
+    [RECONFIGURE_NODE_SFLOW] = "sflow",
+    [RECONFIGURE_NODE_NEIGHBORS] = "neighbors",
+    [RECONFIGURE_NODE_ROUTES] = "routes",
+};
+
+/* Dirty nodes of the reconfiguration in progress. */
+static unsigned int reconfigure_dirty;
+
+/* Set when the bridge data structures no longer follow the database, e.g.
+ * after they were torn down on lock contention or when ports could not be
+ * created, so that the next reconfiguration runs every handler. */
+static bool reconfigure_full = true;
+
+/* Whether each table had rows at the previous reconfiguration.  The IDL
+ * change tracking macros need a row of the table, so a table whose last row
+ * was deleted is detected through these. */
+static struct {
+    bool system, ovs, bridge, vrf, port, iface, vlan, mirror, sflow;
+    bool neighbor, route, nexthop;
+} reconfigure_nonempty;
+
+static bool
+reconfigure_table_changed(bool nonempty, bool changed, bool *was_nonempty)
+{
+    changed = changed || (*was_nonempty && !nonempty);
+    *was_nonempty = nonempty;
+    return changed;
+}
+
+/* Evaluates to true if the table whose first row is FIRST changed since
+ * 'idl_seqno'.  NONEMPTY is its member of 'reconfigure_nonempty'. */
+#define RECONFIGURE_TABLE_CHANGED(FIRST, NONEMPTY)                        \
+    reconfigure_table_changed(                                            \
+        (FIRST) != NULL,                                                  \
+        (FIRST) != NULL                                                   \
+        && (OVSREC_IDL_ANY_TABLE_ROWS_INSERTED(FIRST, idl_seqno)          \
+            || OVSREC_IDL_ANY_TABLE_ROWS_MODIFIED(FIRST, idl_seqno)       \
+            || OVSREC_IDL_ANY_TABLE_ROWS_DELETED(FIRST, idl_seqno)),      \
+        &reconfigure_nonempty.NONEMPTY)
+
+/* Returns the nodes whose tables changed since the last reconfiguration. */
+static unsigned int
+reconfigure_collect_dirty(void)
+{
+    const struct ovsrec_open_vswitch *ovs = ovsrec_open_vswitch_first(idl);
+    const struct ovsrec_system *system = ovsrec_system_first(idl);
+    const struct ovsrec_bridge *bridge = ovsrec_bridge_first(idl);
+    const struct ovsrec_vrf *vrf = ovsrec_vrf_first(idl);
+    const struct ovsrec_port *port = ovsrec_port_first(idl);
+    const struct ovsrec_interface *iface = ovsrec_interface_first(idl);
+    const struct ovsrec_vlan *vlan = ovsrec_vlan_first(idl);
+    const struct ovsrec_mirror *mirror = ovsrec_mirror_first(idl);
+    const struct ovsrec_sflow *sflow = ovsrec_sflow_first(idl);
+    const struct ovsrec_neighbor *neighbor = ovsrec_neighbor_first(idl);
+    const struct ovsrec_route *route = ovsrec_route_first(idl);
+    const struct ovsrec_nexthop *nexthop = ovsrec_nexthop_first(idl);
+    unsigned int dirty = 0;
+
+    /* Every table is checked, so that 'reconfigure_nonempty' stays current
+     * even when the result is overridden by 'reconfigure_full'. */
+    if (RECONFIGURE_TABLE_CHANGED(ovs, ovs)
+        | RECONFIGURE_TABLE_CHANGED(system, system)) {
+        dirty |= NODE(SYSTEM);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(bridge, bridge)
+        | RECONFIGURE_TABLE_CHANGED(vrf, vrf)) {
+        dirty |= NODE(BRIDGES);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(port, port)) {
+        dirty |= NODE(PORTS);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(iface, iface)) {
+        dirty |= NODE(IFACES);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(vlan, vlan)) {
+        dirty |= NODE(VLANS);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(mirror, mirror)) {
+        dirty |= NODE(MIRRORS);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(sflow, sflow)) {
+        dirty |= NODE(SFLOW);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(neighbor, neighbor)) {
+        dirty |= NODE(NEIGHBORS);
+    }
+    if (RECONFIGURE_TABLE_CHANGED(route, route)
+        | RECONFIGURE_TABLE_CHANGED(nexthop, nexthop)) {
+        dirty |= NODE(ROUTES);
+    }
+
+    if (reconfigure_full) {
+        reconfigure_full = false;
+        dirty = RECONFIGURE_ALL_NODES;
+    }
+
+    if (VLOG_IS_DBG_ENABLED()) {
+        struct ds ds = DS_EMPTY_INITIALIZER;
+        int i;
+
+        for (i = 0; i < RECONFIGURE_N_NODES; i++) {
+            if (dirty & (1u << i)) {
+                ds_put_format(&ds, " %s", reconfigure_node_names[i]);
+            }
+        }
+        VLOG_DBG("reconfigure dirty nodes:%s", ds_cstr(&ds));
+        ds_destroy(&ds);
+    }
+    return dirty;
+}
+
+/* Returns true if a handler depending on 'inputs' must run, counting the
+ * handlers that are skipped. */
+static bool
+reconfigure_needs(unsigned int inputs)
+{
+    if (reconfigure_dirty & inputs) {
+        return true;
+    }
+    COVERAGE_INC(bridge_reconfigure_skip);
+    return false;
+}
+
+/* Forces a full reconfiguration if a port of 'wanted_ports' could not be
+ * added to 'br', so that it is retried on the next database change. */
+static void
+reconfigure_check_ports_added(const struct bridge *br,
+                              const struct shash *wanted_ports)
+{
+    struct shash_node *port_node;
+
+    SHASH_FOR_EACH (port_node, wanted_ports) {
+        if (!port_lookup(br, port_node->name)) {
+            reconfigure_full = true;
+            reconfigure_blocks_force_all();
+            break;
+        }
+    }
+}
+
+/* Runs the port pipeline blocks for every bridge and VRF when the pipeline
+ * itself is skipped.  Their callbacks may watch tables of their own, and
+ * those that registered interests are still filtered by them. */
+static void
+reconfigure_run_port_blocks(const struct blk_params *clear_blk_params)
+{
+    static const enum block_id br_blocks[] = {
+        BLK_BR_DELETE_PORTS, BLK_BR_RECONFIGURE_PORTS, BLK_BR_ADD_PORTS,
+    };
+    static const enum block_id vrf_blocks[] = {
+        BLK_VRF_DELETE_PORTS, BLK_VRF_RECONFIGURE_PORTS, BLK_VRF_ADD_PORTS,
+    };
+    struct blk_params params;
+    struct bridge *br;
+    struct vrf *vrf;
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(br_blocks); i++) {
+        HMAP_FOR_EACH (br, node, &all_bridges) {
+            params = *clear_blk_params;
+            params.br = br;
+            params.ofproto = br->ofproto;
+            execute_reconfigure_block(&params, br_blocks[i]);
+        }
+        HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+            params = *clear_blk_params;
+            params.vrf = vrf;
+            params.ofproto = vrf->up->ofproto;
+            execute_reconfigure_block(&params, vrf_blocks[i]);
+        }
+    }
+}
+
+/* Cold start.
+ *
+ * The first reconfiguration programs the whole configuration found in the
+ * database, ports and VLANs of each bridge first, then the L3 interfaces and
+ * neighbors of each VRF, and the routes last.  Neighbors keep being learned
+ * after that, so routes none of whose nexthops is resolved yet can be held
+ * back for up to "cold-start-route-hold" msec from the Open_vSwitch
+ * other_config column instead of being programmed to copy to CPU, then
+ * reprogrammed once per resolved neighbor.  0, the default, disables the
+ * hold. */
+#define DFLT_COLD_START_ROUTE_HOLD 0
+
+static bool cold_start = true;
+static long long int route_hold_deadline = 0;   /* 0 if not holding. */
+
+static void
+bridge_cold_start_begin(const struct ovsrec_open_vswitch *ovs_cfg)
+{
+    int hold = smap_get_int(&ovs_cfg->other_config, "cold-start-route-hold",
+                            DFLT_COLD_START_ROUTE_HOLD);
+
+    if (hold > 0) {
+        VLOG_INFO("cold start: holding unresolved routes for %d ms", hold);
+        route_hold_deadline = time_msec() + hold;
+        vrf_set_route_hold(true);
+    }
+}
+
+/* Programs the routes still held once the cold start route hold expires. */
+static void
+bridge_cold_start_run(void)
+{
+    struct ovsdb_idl_txn *txn;
+    struct vrf *vrf;
+    int n_released = 0;
+
+    if (!route_hold_deadline || time_msec() < route_hold_deadline) {
+        return;
+    }
+    route_hold_deadline = 0;
+    vrf_set_route_hold(false);
+
+    /* Programming a route updates the status of its nexthops. */
+    txn = ovsdb_idl_txn_create(idl);
+    HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+        n_released += vrf_release_held_routes(vrf);
+    }
+    ovsdb_idl_txn_commit(txn);
+    ovsdb_idl_txn_destroy(txn);
+
+    VLOG_INFO("cold start: route hold ended, %d routes programmed "
+              "unresolved", n_released);
+}
+
+static void
+bridge_cold_start_wait(void)
+{
+    if (route_hold_deadline) {
+        poll_timer_wait_until(route_hold_deadline);
+    }
+}
+
+/* Closes the startup timeline once the initial configuration is committed
+ * and the first statistics are published, whichever comes last. */
+static void
+bridge_startup_timeline_check(void)
+{
+    if (initial_config_done && !daemonize_txn && stats_published) {
+        startup_timeline_complete();
+    }
+}
+
+/* Phases of bridge_reconfigure() timed for "bridge/reconfigure-stats". */
+enum reconf_phase {
+    RECONF_PHASE_TOTAL,
+    RECONF_PHASE_ADD_DEL,
+    RECONF_PHASE_DEL_PORTS,
+    RECONF_PHASE_OFPROTO_CREATE,
+    RECONF_PHASE_ADD_PORTS,
+    RECONF_PHASE_PORT_PREPARE,
+    RECONF_PHASE_PORT_CONFIGURE,
+    RECONF_PHASE_VLANS,
+    RECONF_PHASE_MIRRORS,
+    RECONF_PHASE_SFLOW,
+    RECONF_PHASE_NEIGHBORS,
+    RECONF_PHASE_ROUTES,
+    RECONF_PHASE_NEXTHOPS,
+    N_RECONF_PHASES
+};
+
+static const char *reconf_phase_names[N_RECONF_PHASES] = {
+    [RECONF_PHASE_TOTAL] = "total",
+    [RECONF_PHASE_ADD_DEL] = "add_del_bridges/vrfs",
+    [RECONF_PHASE_DEL_PORTS] = "port deletion",
+    [RECONF_PHASE_OFPROTO_CREATE] = "ofproto create",
+    [RECONF_PHASE_ADD_PORTS] = "port add",
+    [RECONF_PHASE_PORT_PREPARE] = "port prepare",
+    [RECONF_PHASE_PORT_CONFIGURE] = "port configure (per port)",
+    [RECONF_PHASE_VLANS] = "vlans",
+    [RECONF_PHASE_MIRRORS] = "mirrors",
+    [RECONF_PHASE_SFLOW] = "sflow",
+    [RECONF_PHASE_NEIGHBORS] = "neighbors",
+    [RECONF_PHASE_ROUTES] = "routes",
+    [RECONF_PHASE_NEXTHOPS] = "nexthops",
+};
+
+/* Duration of each phase in a bridge_reconfigure() run, summed over the
+ * bridges and VRFs it went through.  Port configure is the exception and
+ * gets a sample per port. */
+static struct latency_hist reconf_phase_latency[N_RECONF_PHASES];
+
+/* Time spent so far in each phase by the current run, and the phases that
+ * ran. */
+static long long int reconf_phase_usec[N_RECONF_PHASES];
+static unsigned int reconf_phases_run;
+
+/* Accounts the time since 'start' to 'phase' in the current run. */
+static void
+reconf_phase_add(enum reconf_phase phase, long long int start)
+{
+    reconf_phase_usec[phase] += time_usec() - start;
+    reconf_phases_run |= 1u << phase;
+}
+
+/* Adds to the histograms the phases of the run started at 'start'. */
+static void
+reconf_phases_record(long long int start)
+{
+    int i;
+
+    reconf_phase_add(RECONF_PHASE_TOTAL, start);
+    for (i = 0; i < N_RECONF_PHASES; i++) {
+        if (reconf_phases_run & (1u << i)) {
+            latency_hist_add(&reconf_phase_latency[i], reconf_phase_usec[i]);
+            reconf_phase_usec[i] = 0;
+        }
+    }
+    reconf_phases_run = 0;
+}
+
+static void
+reconf_port_configure(struct port *port, const struct port_prep *prep)
+{
+    long long int start = time_usec();
+
+    port_apply(port, prep);
+    latency_hist_add(&reconf_phase_latency[RECONF_PHASE_PORT_CONFIGURE],
+                     time_usec() - start);
+}
+
+/* Below this number of modified ports per thread, the ports are prepared by
+ * the main thread alone: handing them out costs more than it saves. */
+#define PORT_PREP_MIN_PER_THREAD 64
+#define PORT_PREP_MAX_THREADS 8
+
+/* Ports prepared by the thread of index i: ports[i], ports[i + n_threads]...
+ * into the same index of 'preps'.  The main thread has index 0. */
+struct port_prep_job {
+    struct port **ports;
+    struct port_prep *preps;
+    size_t n_ports;
+    size_t n_threads;
+};
+
+/* Threads that help the main thread prepare the ports, started the first
+ * time a reconfiguration modifies enough ports, then kept waiting for the
+ * next job. */
+static struct ovs_mutex port_prep_mutex = OVS_MUTEX_INITIALIZER;
+static pthread_cond_t port_prep_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t port_prep_done_cond = PTHREAD_COND_INITIALIZER;
+static size_t n_port_prep_workers;
+static uint64_t port_prep_seqno OVS_GUARDED_BY(port_prep_mutex);
+static size_t n_port_prep_busy OVS_GUARDED_BY(port_prep_mutex);
+static struct port_prep_job port_prep_job OVS_GUARDED_BY(port_prep_mutex);
+
+static void
+port_prep_job_run(const struct port_prep_job *job, size_t index)
+{
+    size_t i;
+
+    for (i = index; i < job->n_ports; i += job->n_threads) {
+        port_prepare(job->ports[i], &job->preps[i]);
+    }
+}
+
+OVS_NO_RETURN static void *
+port_prep_worker(void *index_)
+{
+    size_t index = (uintptr_t) index_;
+    struct port_prep_job job;
+    uint64_t seqno = 0;
+
+    ovs_mutex_lock(&port_prep_mutex);
+    for (;;) {
+        while (port_prep_seqno == seqno) {
+            ovs_mutex_cond_wait(&port_prep_cond, &port_prep_mutex);
+        }
+        seqno = port_prep_seqno;
+        job = port_prep_job;
+        ovs_mutex_unlock(&port_prep_mutex);
+
+        /* Workers beyond the job's thread count sit this one out. */
+        if (index < job.n_threads) {
+            port_prep_job_run(&job, index);
+        }
+
+        ovs_mutex_lock(&port_prep_mutex);
+        if (!--n_port_prep_busy) {
+            xpthread_cond_signal(&port_prep_done_cond);
+        }
+    }
+}
+
+/* Runs 'job' on the main thread and 'job->n_threads' - 1 workers, and
+ * returns once every port is prepared.  The IDL does not change meanwhile. */
+static void
+port_prep_pool_run(const struct port_prep_job *job)
+{
+    if (job->n_threads > 1) {
+        size_t n_workers = MAX(n_port_prep_workers, job->n_threads - 1);
+
+        ovs_mutex_lock(&port_prep_mutex);
+        port_prep_job = *job;
+        n_port_prep_busy = n_workers;
+        port_prep_seqno++;
+        xpthread_cond_broadcast(&port_prep_cond);
+        ovs_mutex_unlock(&port_prep_mutex);
+
+        /* A new worker starts with the job just posted. */
+        while (n_port_prep_workers < n_workers) {
+            uintptr_t index = ++n_port_prep_workers;
+
+            ovs_thread_create("port_prep", port_prep_worker, (void *) index);
+        }
+    }
+
+    port_prep_job_run(job, 0);
+
+    if (job->n_threads > 1) {
+        ovs_mutex_lock(&port_prep_mutex);
+        while (n_port_prep_busy) {
+            ovs_mutex_cond_wait(&port_prep_done_cond, &port_prep_mutex);
+        }
+        ovs_mutex_unlock(&port_prep_mutex);
+    }
+}
+
+/* Returns true if the configuration of 'port', or of one of its interfaces,
+ * changed in this run, i.e. if it must be configured again. */
+static bool
+port_is_modified(const struct port *port)
+{
+    const struct iface *iface;
+
+#ifndef OPS_TEMP
+    if (port->cfg->vlan_mode && !strcmp(port->cfg->vlan_mode, "splinter")) {
+        return false;
+    }
+#endif
+    if (OVSREC_IDL_IS_ROW_MODIFIED(port->cfg, idl_seqno)) {
+        return true;
+    }
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        if (OVSREC_IDL_IS_ROW_MODIFIED(iface->cfg, idl_seqno)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Configures a modified port for bridge_configure_ports(): applies 'prep' to
+ * it with reconf_port_configure(), and does the rest of its configuration. */
+typedef void port_configure_func(struct port *, const struct port_prep *prep,
+                                 void *aux);
+
+/* Configures every modified port in 'ports', in order, with 'configure', and
+ * returns their number.  port_prepare() only reads the database rows and the
+ * port, so the settings of the ports of a large reconfiguration are first
+ * prepared by the main thread and the port_prep workers together.  Everything
+ * that has a side effect is left to 'configure', called from the main
+ * thread. */
+static size_t
+bridge_configure_ports(struct hmap *ports, port_configure_func *configure,
+                       void *aux)
+{
+    long long int phase_start = time_usec();
+    struct port_prep_job job;
+    struct port_prep *preps;
+    struct port **modified;
+    size_t n_modified, max_threads, i;
+    struct port *port;
+
+    n_modified = 0;
+    modified = xmalloc(hmap_count(ports) * sizeof *modified);
+    HMAP_FOR_EACH (port, hmap_node, ports) {
+        if (port_is_modified(port)) {
+            modified[n_modified++] = port;
+        }
+    }
+    preps = xmalloc(n_modified * sizeof *preps);
+
+    max_threads = MIN(PORT_PREP_MAX_THREADS, MAX(count_cpu_cores(), 1));
+    job.ports = modified;
+    job.preps = preps;
+    job.n_ports = n_modified;
+    job.n_threads = MAX(MIN(n_modified / PORT_PREP_MIN_PER_THREAD,
+                            max_threads), 1);
+    port_prep_pool_run(&job);
+    if (job.n_threads > 1) {
+        VLOG_DBG("prepared %"PRIuSIZE" ports with %"PRIuSIZE" threads",
+                 n_modified, job.n_threads);
+    }
+    reconf_phase_add(RECONF_PHASE_PORT_PREPARE, phase_start);
+
+    for (i = 0; i < n_modified; i++) {
+        VLOG_DBG("config port - %s", modified[i]->name);
+        configure(modified[i], &preps[i], aux);
+        port_prep_destroy(&preps[i]);
+    }
+
+    free(preps);
+    free(modified);
+    return n_modified;
+}
+
+/* port_configure_func for the ports of bridge 'br_'. */
+static void
+bridge_port_configure(struct port *port, const struct port_prep *prep,
+                      void *br_)
+{
+    struct bridge *br = br_;
+    struct blk_params blk_params = {
+        .idl_seqno = idl_seqno,
+        .idl = idl,
+        .ofproto = br->ofproto,
+        .br = br,
+        .port = port,
+        .all_bridges = &all_bridges,
+        .all_vrfs = &all_vrfs,
+    };
+    struct iface *iface;
+
+    reconf_port_configure(port, prep);
+
+    /* Execute the reconfigure for block BLK_BR_PORT_UPDATE */
+    execute_reconfigure_block(&blk_params, BLK_BR_PORT_UPDATE);
+
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        if (OVSREC_IDL_IS_ROW_MODIFIED(iface->cfg, idl_seqno)) {
+            iface_set_ofport(iface->cfg, iface->ofp_port);
+        }
+    }
+
+#ifndef OPS_TEMP
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        /* Clear eventual previous errors */
+        ovsrec_interface_set_error(iface->cfg, NULL);
+
+        iface_configure_cfm(iface);
+        iface_configure_qos(iface, port->cfg->qos);
+        iface_set_mac(br, port, iface);
+        ofproto_port_set_bfd(br->ofproto, iface->ofp_port,
+                             &iface->cfg->bfd);
+    }
+#endif
+}
+
+/* port_configure_func for the ports of VRF 'vrf_'. */
+static void
+vrf_port_configure(struct port *port, const struct port_prep *prep,
+                   void *vrf_)
+{
+    struct vrf *vrf = vrf_;
+    struct blk_params blk_params = {
+        .idl_seqno = idl_seqno,
+        .idl = idl,
+        .ofproto = vrf->up->ofproto,
+        .vrf = vrf,
+        .port = port,
+        .all_bridges = &all_bridges,
+        .all_vrfs = &all_vrfs,
+    };
+    struct iface *iface;
+
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        /* Setting the hardware interface configuration for internal
+         * interfaces */
+        if (OVSREC_IDL_IS_ROW_MODIFIED(iface->cfg, idl_seqno)
+            && (!iface->type
+                || !strcmp(iface->type, OVSREC_INTERFACE_TYPE_INTERNAL)
+                || !strcmp(iface->cfg->type,
+                           OVSREC_INTERFACE_TYPE_VLANSUBINT))) {
+            netdev_set_hw_intf_config(iface->netdev,
+                                      &iface->cfg->hw_intf_config);
+        }
+    }
+
+    reconf_port_configure(port, prep);
+
+    /* Execute the reconfigure for block BLK_VRF_PORT_UPDATE */
+    execute_reconfigure_block(&blk_params, BLK_VRF_PORT_UPDATE);
+}
+
+static void
+bridge_unixctl_reconfigure_stats(struct unixctl_conn *conn,
+                                 int argc OVS_UNUSED,
+                                 const char *argv[] OVS_UNUSED,
+                                 void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    int i;
+
+    ds_put_cstr(&ds, "Reconfigure phases:\n");
+    latency_hist_format_header(&ds);
+    for (i = 0; i < N_RECONF_PHASES; i++) {
+        latency_hist_format(&ds, reconf_phase_names[i],
+                            &reconf_phase_latency[i]);
+    }
+
+    ds_put_cstr(&ds, "\nReconfigure blocks:\n");
+    latency_hist_format_header(&ds);
+    for (i = 0; i < MAX_BLOCKS_NUM; i++) {
+        latency_hist_format(&ds, reconfigure_block_name(i),
+                            reconfigure_block_latency(i));
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+#endif
+
 static void
 bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
 {
@@ -862,6 +1639,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
     struct vrf *vrf, *vrf_next;
     int sflow_bridge_number = 0;
     const struct ovsrec_system *system_row = ovsrec_system_first(idl);
+    bool topology_changed;
     struct blk_params bridge_blk_params;
     const struct blk_params clear_blk_params = {
         .idl_seqno = idl_seqno,
@@ -873,6 +1651,9 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
         .all_bridges = &all_bridges,
         .all_vrfs = &all_vrfs,
     };
+
+    /* Timing of the phases below, for "bridge/reconfigure-stats". */
+    long long int reconf_start, phase_start;
 #endif
 
     struct sockaddr_in *managers;
@@ -880,6 +1661,15 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
 
     COVERAGE_INC(bridge_reconfigure);
 
+#ifdef OPS
+    reconf_start = time_usec();
+    if (cold_start) {
+        cold_start = false;
+        bridge_cold_start_begin(ovs_cfg);
+    }
+    reconfigure_dirty = reconfigure_collect_dirty();
+    if (reconfigure_needs(HANDLER_SYSTEM)) {
+#endif
     ofproto_set_flow_limit(smap_get_int(&ovs_cfg->other_config, "flow-limit",
                                         OFPROTO_FLOW_LIMIT_DEFAULT));
     ofproto_set_max_idle(smap_get_int(&ovs_cfg->other_config, "max-idle",
@@ -892,22 +1682,44 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
     ofproto_set_threads(
         smap_get_int(&ovs_cfg->other_config, "n-handler-threads", 0),
         smap_get_int(&ovs_cfg->other_config, "n-revalidator-threads", 0));
+#ifdef OPS
+    callback_stats_set_slow_threshold(
+        smap_get_int(&ovs_cfg->other_config, "slow-callback-threshold",
+                     CALLBACK_STATS_DFLT_SLOW_THRESHOLD));
+    sflow_governor_configure(&ovs_cfg->other_config);
+    }
+#endif
 
     /* Destroy "struct bridge"s, "struct port"s, and "struct iface"s according
      * to 'ovs_cfg', with only very minimal configuration otherwise.
      *
      * This is mostly an update to bridge data structures. Nothing is pushed
      * down to ofproto or lower layers. */
-    add_del_bridges(ovs_cfg);
-
 #ifdef OPS
-    add_del_vrfs(ovs_cfg);
+    topology_changed = reconfigure_needs(HANDLER_TOPOLOGY);
+    if (topology_changed) {
+        phase_start = time_usec();
+        add_del_bridges(ovs_cfg);
+        add_del_vrfs(ovs_cfg);
+        reconf_phase_add(RECONF_PHASE_ADD_DEL, phase_start);
+    }
 
     /* Execute the reconfigure for block BLK_INIT_RECONFIGURE */
     bridge_blk_params = clear_blk_params;
     execute_reconfigure_block(&bridge_blk_params, BLK_INIT_RECONFIGURE);
+
+    /* The port pipeline below only runs when bridges, ports or interfaces
+     * changed.  Its plugin blocks run in any case. */
+    if (!topology_changed) {
+        reconfigure_run_port_blocks(&clear_blk_params);
+    } else {
+#else
+    add_del_bridges(ovs_cfg);
 #endif
 
+#ifdef OPS
+    phase_start = time_usec();
+#endif
 #ifndef OPS_TEMP
     splinter_vlans = collect_splinter_vlans(ovs_cfg);
 #endif
@@ -988,6 +1800,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
             execute_reconfigure_block(&bridge_blk_params, BLK_VRF_RECONFIGURE_PORTS);
         }
     }
+    reconf_phase_add(RECONF_PHASE_DEL_PORTS, phase_start);
 #endif
 
 
@@ -996,11 +1809,18 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
      *     - Create ofprotos that are missing.
      *
      *     - Add ports that are missing. */
+#ifdef OPS
+    phase_start = time_usec();
+#endif
     HMAP_FOR_EACH_SAFE (br, next, node, &all_bridges) {
         if (!br->ofproto) {
             int error;
 
             error = ofproto_create(br->name, br->type, &br->ofproto);
+#ifdef OPS
+            br->sflow_set = false;
+            bridge_forget_bundles(br);
+#endif
             if (error) {
                 VLOG_ERR("failed to create bridge %s: %s", br->name,
                          ovs_strerror(error));
@@ -1019,6 +1839,8 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
             int error;
 
             error = ofproto_create(vrf->up->name, "vrf", &vrf->up->ofproto);
+            vrf->up->sflow_set = false;
+            bridge_forget_bundles(vrf->up);
             if (error) {
                 VLOG_ERR("failed to create vrf %s: %s", vrf->up->name,
                          ovs_strerror(error));
@@ -1030,6 +1852,8 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
             }
         }
     }
+    reconf_phase_add(RECONF_PHASE_OFPROTO_CREATE, phase_start);
+    phase_start = time_usec();
 #endif
     HMAP_FOR_EACH (br, node, &all_bridges) {
         bridge_add_ports(br, &br->wanted_ports);
@@ -1039,6 +1863,7 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
         bridge_blk_params.br = br;
         bridge_blk_params.ofproto = br->ofproto;
         execute_reconfigure_block(&bridge_blk_params, BLK_BR_ADD_PORTS);
+        reconfigure_check_ports_added(br, &br->wanted_ports);
 #endif
         shash_destroy(&br->wanted_ports);
     }
@@ -1052,12 +1877,19 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
         bridge_blk_params.vrf = vrf;
         bridge_blk_params.ofproto = vrf->up->ofproto;
         execute_reconfigure_block(&bridge_blk_params, BLK_VRF_ADD_PORTS);
+        reconfigure_check_ports_added(vrf->up, &vrf->up->wanted_ports);
 
         shash_destroy(&vrf->up->wanted_ports);
     }
-#endif
+    reconf_phase_add(RECONF_PHASE_ADD_PORTS, phase_start);
+    }
 
+    if (reconfigure_needs(HANDLER_SYSTEM)) {
+        reconfigure_system_stats(ovs_cfg);
+    }
+#else
     reconfigure_system_stats(ovs_cfg);
+#endif
 
 //CONTINUE
 
@@ -1067,74 +1899,72 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
 #endif
     collect_in_band_managers(ovs_cfg, &managers, &n_managers);
     HMAP_FOR_EACH (br, node, &all_bridges) {
+#ifndef OPS
         struct port *port;
+#endif
 
         VLOG_DBG("config bridge - %s", br->name);
         /* We need the datapath ID early to allow LACP ports to use it as the
          * default system ID. */
+#ifdef OPS
+        if (reconfigure_needs(HANDLER_DP_ID)) {
+            bridge_configure_datapath_id(br);
+        }
+
+        /* Without port or interface changes no port below is modified. */
+        if (reconfigure_needs(HANDLER_PORTS)) {
+            bridge_configure_ports(&br->ports, bridge_port_configure, br);
+        }
+#else
         bridge_configure_datapath_id(br);
 
         HMAP_FOR_EACH (port, hmap_node, &br->ports) {
             struct iface *iface;
 
-#ifdef OPS
-            /* For a bond port, reconfigure the port if any of the
-               member interface rows change. */
-            bool port_iface_changed = false;
+            VLOG_DBG("config port - %s", port->name);
+            port_configure(port);
+
             LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                if (OVSREC_IDL_IS_ROW_MODIFIED(iface->cfg, idl_seqno)) {
-                    port_iface_changed = true;
-                    break;
-                }
+                iface_set_ofport(iface->cfg, iface->ofp_port);
             }
-            if (OVSREC_IDL_IS_ROW_MODIFIED(port->cfg, idl_seqno) ||
-                (port_iface_changed == true)) {
-#endif
-                VLOG_DBG("config port - %s", port->name);
-                port_configure(port);
-#ifdef OPS
-                /* Execute the reconfigure for block BLK_BR_PORT_UPDATE */
-                bridge_blk_params = clear_blk_params;
-                bridge_blk_params.port = port;
-                bridge_blk_params.br = br;
-                bridge_blk_params.ofproto = br->ofproto;
-                execute_reconfigure_block(&bridge_blk_params, BLK_BR_PORT_UPDATE);
-#endif
 
-                LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-#ifdef OPS
-                    if (OVSREC_IDL_IS_ROW_MODIFIED(iface->cfg, idl_seqno)) {
-#endif
-                        iface_set_ofport(iface->cfg, iface->ofp_port);
-#ifdef OPS
-                    }
-#endif
-                }
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                /* Clear eventual previous errors */
+                ovsrec_interface_set_error(iface->cfg, NULL);
 
-#ifndef OPS_TEMP
-                LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                    /* Clear eventual previous errors */
-                    ovsrec_interface_set_error(iface->cfg, NULL);
-
-                    iface_configure_cfm(iface);
-                    iface_configure_qos(iface, port->cfg->qos);
-                    iface_set_mac(br, port, iface);
-                    ofproto_port_set_bfd(br->ofproto, iface->ofp_port,
+                iface_configure_cfm(iface);
+                iface_configure_qos(iface, port->cfg->qos);
+                iface_set_mac(br, port, iface);
+                ofproto_port_set_bfd(br->ofproto, iface->ofp_port,
                                      &iface->cfg->bfd);
-                }
-#endif
-#ifdef OPS
             }
-#endif
         }
-#ifdef OPS
-        bridge_configure_vlans(br);
 #endif
+#ifdef OPS
+
+        if (reconfigure_needs(HANDLER_VLANS)) {
+            phase_start = time_usec();
+            bridge_configure_vlans(br);
+            reconf_phase_add(RECONF_PHASE_VLANS, phase_start);
+        }
+        if (reconfigure_needs(HANDLER_MIRRORS)) {
+            phase_start = time_usec();
+            bridge_configure_mirrors(br);
+            reconf_phase_add(RECONF_PHASE_MIRRORS, phase_start);
+        }
+#else
         bridge_configure_mirrors(br);
+#endif
 #ifndef OPS_TEMP
         bridge_configure_forward_bpdu(br);
 #endif
+#ifdef OPS
+        if (reconfigure_needs(HANDLER_BRIDGE)) {
+            bridge_configure_mac_table(br);
+        }
+#else
         bridge_configure_mac_table(br);
+#endif
 #ifndef OPS_TEMP
         bridge_configure_mcast_snooping(br);
         bridge_configure_netflow(br);
@@ -1144,18 +1974,28 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
 #endif
 #ifdef OPS
         /* Use from global sflow config in the System table.  */
-        if (system_row && system_row->sflow) {
-            bridge_configure_sflow(br, system_row->sflow,
-                                   &sflow_bridge_number);
-        } else {
-            ofproto_set_sflow(br->ofproto, NULL);
+        if (reconfigure_needs(HANDLER_SFLOW)) {
+            phase_start = time_usec();
+            if (system_row && system_row->sflow) {
+                bridge_configure_sflow(br, system_row->sflow,
+                                       &sflow_bridge_number);
+            } else {
+                bridge_set_sflow(br, NULL);
+            }
+            reconf_phase_add(RECONF_PHASE_SFLOW, phase_start);
         }
-#endif
 
+        if (reconfigure_needs(HANDLER_BRIDGE)) {
+            bridge_configure_remotes(br, managers, n_managers);
+            bridge_configure_tables(br);
+            bridge_configure_dp_desc(br);
+        }
+#else
         bridge_configure_remotes(br, managers, n_managers);
         bridge_configure_tables(br);
 
         bridge_configure_dp_desc(br);
+#endif
 
 #ifdef OPS
         /* Execute the reconfigure for block BLK_BR_FEATURE_RECONFIG */
@@ -1168,51 +2008,22 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
 
 #ifdef OPS
     HMAP_FOR_EACH (vrf, node, &all_vrfs) {
-        struct port *port;
         bool   is_port_configured = false;
 
         VLOG_DBG("config vrf - %s", vrf->up->name);
-        HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
-            struct iface *iface;
-
-            /* For a bond port, reconfigure the port if any of the
-               member interface rows change. */
-            bool port_iface_changed = false;
-            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                if (OVSREC_IDL_IS_ROW_MODIFIED(iface->cfg, idl_seqno)) {
-                    port_iface_changed = true;
-
-                    /* Setting the hardware interface configuration for
-                     * internal interfaces */
-                    if (!iface->type
-                        || (!strcmp(iface->type,
-                                  OVSREC_INTERFACE_TYPE_INTERNAL))
-                        || (!strcmp(iface->cfg->type,
-                                  OVSREC_INTERFACE_TYPE_VLANSUBINT))) {
-                                  netdev_set_hw_intf_config (iface->netdev,
-                                  &(iface->cfg->hw_intf_config));
-                    }
-                }
-            }
-            if (OVSREC_IDL_IS_ROW_MODIFIED(port->cfg, idl_seqno) ||
-                (port_iface_changed == true)) {
-                VLOG_DBG("config port - %s", port->name);
-                port_configure(port);
-                is_port_configured = true;
-
-                /* Execute the reconfigure for block BLK_VRF_PORT_UPDATE */
-                bridge_blk_params = clear_blk_params;
-                bridge_blk_params.port = port;
-                bridge_blk_params.vrf = vrf;
-                bridge_blk_params.ofproto = vrf->up->ofproto;
-                execute_reconfigure_block(&bridge_blk_params, BLK_VRF_PORT_UPDATE);
-            }
+        /* Without port or interface changes no port below is modified. */
+        if (reconfigure_needs(HANDLER_PORTS)) {
+            is_port_configured = bridge_configure_ports(&vrf->up->ports,
+                                                        vrf_port_configure,
+                                                        vrf) > 0;
         }
 
         /* Add any exisiting neighbors refering this vrf and ports after
         ** port_configure */
         if( is_port_configured ) {
+            phase_start = time_usec();
             vrf_add_neighbors(vrf);
+            reconf_phase_add(RECONF_PHASE_NEIGHBORS, phase_start);
 
             /* Execute the reconfigure for block BLK_VRF_ADD_NEIGHBORS */
             bridge_blk_params = clear_blk_params;
@@ -1222,16 +2033,36 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
         }
         /* Check for any other new addition/deletion/modifications to neighbor
         ** table. */
-        vrf_reconfigure_neighbors(vrf);
-        vrf_reconfigure_routes(vrf);
-        vrf_reconfigure_nexthops(vrf);
+        if (reconfigure_needs(HANDLER_NEIGHBORS)) {
+            phase_start = time_usec();
+            vrf_reconfigure_neighbors(vrf);
+            reconf_phase_add(RECONF_PHASE_NEIGHBORS, phase_start);
+        }
+    }
+
+    /* Routes are configured once the L3 interfaces and neighbors of every
+     * VRF are, so that their nexthops resolve when they are first
+     * programmed. */
+    HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+        if (reconfigure_needs(HANDLER_ROUTES)) {
+            phase_start = time_usec();
+            vrf_reconfigure_routes(vrf);
+            reconf_phase_add(RECONF_PHASE_ROUTES, phase_start);
+            phase_start = time_usec();
+            vrf_reconfigure_nexthops(vrf);
+            reconf_phase_add(RECONF_PHASE_NEXTHOPS, phase_start);
+        }
 
         /* Use from global sflow config in the System table.  */
-        if (system_row && system_row->sflow) {
-            bridge_configure_sflow(vrf->up, system_row->sflow,
-                                   &sflow_bridge_number);
-        } else {
-            ofproto_set_sflow(vrf->up->ofproto, NULL);
+        if (reconfigure_needs(HANDLER_SFLOW)) {
+            phase_start = time_usec();
+            if (system_row && system_row->sflow) {
+                bridge_configure_sflow(vrf->up, system_row->sflow,
+                                       &sflow_bridge_number);
+            } else {
+                bridge_set_sflow(vrf->up, NULL);
+            }
+            reconf_phase_add(RECONF_PHASE_SFLOW, phase_start);
         }
 
         /* Execute the reconfigure for block BLK_RECONFIGURE_NEIGHBORS */
@@ -1252,6 +2083,9 @@ bridge_reconfigure(const struct ovsrec_open_vswitch *ovs_cfg)
      * narrow race window in which e.g. ofproto/trace will not recognize the
      * new configuration (sometimes this causes unit test failures). */
     bridge_run__();
+#ifdef OPS
+    reconf_phases_record(reconf_start);
+#endif
 }
 
 /* Delete ofprotos which aren't configured or have the wrong type.  Create
@@ -1436,35 +2270,124 @@ bridge_delete_or_reconfigure_ports(struct bridge *br)
             }
         }
 
-        if (list_is_empty(&port->ifaces)) {
-            port_destroy(port);
-        }
-    }
-    sset_destroy(&ofproto_ports);
+        if (list_is_empty(&port->ifaces)) {
+            port_destroy(port);
+        }
+    }
+    sset_destroy(&ofproto_ports);
+}
+
+#ifdef OPS
+/* Stores in '*parent' the name of the parent interface of the subinterface
+ * 'iface_cfg', or "" if it has none, and in '*vlan' its VLAN. */
+static void
+get_subinterface_parent(const struct ovsrec_interface *iface_cfg,
+                        const char **parent, int *vlan)
+{
+    *parent = "";
+    *vlan = 0;
+    if (iface_cfg->n_subintf_parent > 0) {
+        *parent = iface_cfg->value_subintf_parent[0]->name;
+        *vlan = iface_cfg->key_subintf_parent[0];
+    }
+}
+
+static void
+get_subinterface_info(struct smap *sub_intf_info,
+                      const struct ovsrec_interface *iface_cfg)
+{
+    const char *parent_intf_name;
+    int sub_intf_vlan;
+
+    get_subinterface_parent(iface_cfg, &parent_intf_name, &sub_intf_vlan);
+
+    smap_add(sub_intf_info, "parent_intf_name", parent_intf_name);
+    smap_add_format(sub_intf_info, "vlan", "%d", sub_intf_vlan);
+
+    VLOG_DBG("parent_intf_name %s\n", parent_intf_name);
+    VLOG_DBG("vlan %d\n", sub_intf_vlan);
+}
+
+/* Returns true if the parent interface or the VLAN of the subinterface
+ * 'iface' differ from the ones last applied to its netdev. */
+static bool
+iface_subintf_changed(const struct iface *iface)
+{
+    const char *parent;
+    int vlan;
+
+    get_subinterface_parent(iface->cfg, &parent, &vlan);
+    return (!iface->subintf_parent
+            || vlan != iface->subintf_vlan
+            || strcmp(parent, iface->subintf_parent));
+}
+
+/* Forgets the parent interface applied to the netdev of the subinterface
+ * 'iface', so that its configuration is pushed again. */
+static void
+iface_subintf_forget(struct iface *iface)
+{
+    if (iface->subintf_parent) {
+        hmap_remove(&subintfs_by_parent, &iface->subintf_node);
+        free(iface->subintf_parent);
+        iface->subintf_parent = NULL;
+    }
+}
+
+/* Records the parent interface and VLAN of the subinterface 'iface' as the
+ * ones applied to its netdev. */
+static void
+iface_subintf_applied(struct iface *iface)
+{
+    const char *parent;
+
+    iface_subintf_forget(iface);
+    get_subinterface_parent(iface->cfg, &parent, &iface->subintf_vlan);
+    iface->subintf_parent = xstrdup(parent);
+    hmap_insert(&subintfs_by_parent, &iface->subintf_node,
+                hash_string(parent, 0));
 }
 
-#ifdef OPS
+/* Called when the interface named 'parent' is destroyed or, if 'created', was
+ * just created.  The netdevs of its subinterfaces referred to the previous
+ * parent netdev, so their configuration is pushed again right away if the
+ * parent exists, or by the next reconfiguration otherwise. */
 static void
-get_subinterface_info(struct smap *sub_intf_info,
-                      const struct ovsrec_interface *iface_cfg)
+iface_subintf_parent_changed(const char *parent, bool created)
 {
-    const struct ovsrec_interface *parent_intf_cfg = NULL;
-    int sub_intf_vlan = 0;
+    struct iface **subintfs, *iface;
+    size_t n, allocated, i;
+    struct smap sub_intf_info;
 
-    if (iface_cfg->n_subintf_parent > 0) {
-        parent_intf_cfg = iface_cfg->value_subintf_parent[0];
-        sub_intf_vlan = iface_cfg->key_subintf_parent[0];
+    /* Collect the subinterfaces first, since they move in the index. */
+    subintfs = NULL;
+    n = allocated = 0;
+    HMAP_FOR_EACH_WITH_HASH (iface, subintf_node, hash_string(parent, 0),
+                             &subintfs_by_parent) {
+        if (!strcmp(iface->subintf_parent, parent)) {
+            if (n >= allocated) {
+                subintfs = x2nrealloc(subintfs, &allocated, sizeof *subintfs);
+            }
+            subintfs[n++] = iface;
+        }
     }
 
-    smap_add(sub_intf_info,
-             "parent_intf_name",
-             parent_intf_cfg ? parent_intf_cfg->name : "");
-
-    smap_add_format(sub_intf_info, "vlan", "%d", sub_intf_vlan);
+    for (i = 0; i < n; i++) {
+        iface = subintfs[i];
+        iface_subintf_forget(iface);
+        if (!created) {
+            continue;
+        }
 
-    VLOG_DBG("parent_intf_name %s\n",
-             parent_intf_cfg ? parent_intf_cfg->name : "");
-    VLOG_DBG("vlan %d\n", sub_intf_vlan);
+        COVERAGE_INC(bridge_subintf_reconfigure);
+        smap_init(&sub_intf_info);
+        get_subinterface_info(&sub_intf_info, iface->cfg);
+        if (!netdev_set_config(iface->netdev, &sub_intf_info, NULL)) {
+            iface_subintf_applied(iface);
+        }
+        smap_destroy(&sub_intf_info);
+    }
+    free(subintfs);
 }
 #endif
 
@@ -1515,12 +2438,20 @@ vrf_delete_or_reconfigure_ports(struct vrf *vrf)
         }
 #ifdef OPS
         if (!strcmp(iface->cfg->type, OVSREC_INTERFACE_TYPE_VLANSUBINT)) {
+           /* Only push the configuration of the subinterfaces whose parent
+            * or VLAN changed, there may be thousands of them. */
+           if (!iface_subintf_changed(iface)) {
+              COVERAGE_INC(bridge_subintf_unchanged);
+              continue;
+           }
+           COVERAGE_INC(bridge_subintf_reconfigure);
            smap_init(&sub_intf_info);
            get_subinterface_info(&sub_intf_info, iface->cfg);
            ret = netdev_set_config(iface->netdev, &sub_intf_info, NULL);
            smap_destroy(&sub_intf_info);
            if (ret)
               goto delete;
+           iface_subintf_applied(iface);
            continue;
         }
 #endif
@@ -1627,43 +2558,154 @@ bridge_add_ports(struct bridge *br, const struct shash *wanted_ports)
 #endif
 }
 
+#ifdef OPS
 static void
-port_configure(struct port *port)
+port_bundle_key_put_int(struct ds *key, int64_t value)
 {
-    const struct ovsrec_port *cfg = port->cfg;
-    struct bond_settings bond_settings;
-#ifndef OPS
-    struct lacp_settings lacp_settings;
+    ds_put_buffer(key, (const char *) &value, sizeof value);
+}
+
+static void
+port_bundle_key_put_string(struct ds *key, const char *s)
+{
+    ds_put_cstr(key, s);
+    ds_put_char(key, '\0');
+}
+
+/* Stores in 'key' every setting of 's' filled in by port_prepare() and
+ * port_configure_bond(), so that two settings are the same exactly when their
+ * keys are.  Maps are stored sorted, so that their iteration order does not
+ * matter. */
+static void
+port_bundle_key(const struct ofproto_bundle_settings *s, struct ds *key)
+{
+#ifdef OPS_TEMP
+    size_t i, j;
+#endif
+
+    ds_clear(key);
+    port_bundle_key_put_string(key, s->name);
+    port_bundle_key_put_int(key, s->n_slaves);
+    ds_put_buffer(key, (const char *) s->slaves,
+                  s->n_slaves * sizeof *s->slaves);
+    port_bundle_key_put_int(key, s->n_slaves_tx_enable);
+    ds_put_buffer(key, (const char *) s->slaves_tx_enable,
+                  s->n_slaves_tx_enable * sizeof *s->slaves_tx_enable);
+    port_bundle_key_put_int(key, s->slaves_entered);
+    port_bundle_key_put_int(key, (s->enable << 3)
+                                 | (s->hw_bond_should_exist << 2)
+                                 | (s->bond_handle_alloc_only << 1)
+                                 | s->use_priority_tags);
+    port_bundle_key_put_int(key, s->vlan);
+    port_bundle_key_put_int(key, s->vlan_mode);
+    port_bundle_key_put_int(key, s->trunks != NULL);
+    if (s->trunks) {
+        ds_put_buffer(key, (const char *) s->trunks, bitmap_n_bytes(4096));
+    }
+
+    port_bundle_key_put_int(key, s->bond != NULL);
+    if (s->bond) {
+        port_bundle_key_put_int(key, s->bond->balance);
+        port_bundle_key_put_int(key, s->bond->basis);
+        port_bundle_key_put_int(key, s->bond->rebalance_interval);
+        port_bundle_key_put_int(key, s->bond->lacp_fallback_ab_cfg);
+        ds_put_buffer(key, (const char *) &s->bond->active_slave_mac,
+                      sizeof s->bond->active_slave_mac);
+    }
+
+#ifdef OPS_TEMP
+    for (i = 0; i < ARRAY_SIZE(s->port_options); i++) {
+        const struct smap_node **nodes;
+
+        if (!s->port_options[i]) {
+            port_bundle_key_put_int(key, -1);
+            continue;
+        }
+        port_bundle_key_put_int(key, smap_count(s->port_options[i]));
+        nodes = smap_sort(s->port_options[i]);
+        for (j = 0; j < smap_count(s->port_options[i]); j++) {
+            port_bundle_key_put_string(key, nodes[j]->key);
+            port_bundle_key_put_string(key, nodes[j]->value);
+        }
+        free(nodes);
+    }
 #endif
-    struct ofproto_bundle_settings s;
+}
+
+/* Makes the next port_apply() register the settings of 'port' whatever they
+ * are, because ofproto no longer has those registered last, or their slaves
+ * changed. */
+static void
+port_bundle_forget(struct port *port)
+{
+    port->bundle_registered = false;
+    free(port->bundle_key);
+    port->bundle_key = NULL;
+    port->bundle_key_len = 0;
+}
+
+/* Forgets the settings registered for the ports of 'br', whose ofproto was
+ * just created. */
+static void
+bridge_forget_bundles(struct bridge *br)
+{
+    struct port *port;
+
+    HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+        port_bundle_forget(port);
+    }
+}
+
+/* Returns true if 's', whose port_bundle_key() is 'key', must be registered
+ * for 'port', that is if it differs from the settings registered last or
+ * carries a one-shot request. */
+static bool
+port_bundle_changed(struct port *port, const struct ofproto_bundle_settings *s,
+                    const struct ds *key)
+{
+    if (port->bundle_registered && port->bundle_key_len == key->length
+        && !memcmp(port->bundle_key, key->string, key->length)
+        && !s->ip_change && !s->bond_handle_alloc_only) {
+        return false;
+    }
+    free(port->bundle_key);
+    port->bundle_key = xmemdup(key->string, key->length);
+    port->bundle_key_len = key->length;
+    port->bundle_registered = true;
+    return true;
+}
+#endif
+
+/* Builds in 'prep' the bundle settings of 'port' from its database rows.
+ * This has no side effect, which port_apply() takes care of, so that the
+ * ports of a large reconfiguration can be prepared by worker threads. */
+static void
+port_prepare(struct port *port, struct port_prep *prep)
+{
+    const struct ovsrec_port *cfg = port->cfg;
+    struct ofproto_bundle_settings *s = &prep->s;
     struct iface *iface;
 #ifdef OPS
-    memset(&s, 0, sizeof s);
-
-    int prev_bond_handle = port->bond_hw_handle;
     int cfg_slave_count;
     bool lacp_enabled = false;
     bool lacp_active = false;   /* Not used. */
 #endif
-#ifndef OPS_TEMP
-    if (cfg->vlan_mode && !strcmp(cfg->vlan_mode, "splinter")) {
-        configure_splinter_port(port);
-        return;
-    }
-#endif
+
+    memset(prep, 0, sizeof *prep);
+
     /* Get name. */
-    s.name = port->name;
+    s->name = port->name;
 
     /* Get slaves. */
-    s.n_slaves = 0;
-    s.slaves = xmalloc(list_size(&port->ifaces) * sizeof *s.slaves);
+    s->n_slaves = 0;
+    s->slaves = xmalloc(list_size(&port->ifaces) * sizeof *s->slaves);
 #ifdef OPS
     cfg_slave_count = list_size(&port->ifaces);
-    s.slaves_entered = cfg_slave_count;
-    s.n_slaves_tx_enable = 0;
-    s.slaves_tx_enable = xmalloc(cfg_slave_count * sizeof *s.slaves);
+    s->slaves_entered = cfg_slave_count;
+    s->n_slaves_tx_enable = 0;
+    s->slaves_tx_enable = xmalloc(cfg_slave_count * sizeof *s->slaves);
 
-    s.enable = smap_get_bool(&cfg->hw_config,
+    s->enable = smap_get_bool(&cfg->hw_config,
             PORT_HW_CONFIG_MAP_ENABLE,
             PORT_HW_CONFIG_MAP_ENABLE_DEFAULT);
 
@@ -1672,49 +2714,49 @@ port_configure(struct port *port)
 #endif
     LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
 #ifndef OPS_TEMP
-        s.slaves[s.n_slaves++] = iface->ofp_port;
+        s->slaves[s->n_slaves++] = iface->ofp_port;
 #else
         /* This should be moved outside the for statement as the evaluated variables
            dont depend on the for. */
         if ((strncmp(port->name, "lag", 3) == 0) || (cfg_slave_count > 1) || lacp_enabled) {
             /* Static LAG with 2 or more interfaces, or LACP has been enabled
              * for this bond.  A bond should exist in h/w. */
-            s.hw_bond_should_exist = true;
+            s->hw_bond_should_exist = true;
 
             /* Add only the interfaces with hw_bond_config:rx_enabled set. */
             if (smap_get_bool(&iface->cfg->hw_bond_config,
                               INTERFACE_HW_BOND_CONFIG_MAP_RX_ENABLED,
                               false)) {
-                s.slaves[s.n_slaves++] = iface->ofp_port;
+                s->slaves[s->n_slaves++] = iface->ofp_port;
             }
             if (smap_get_bool(&iface->cfg->hw_bond_config,
                               INTERFACE_HW_BOND_CONFIG_MAP_TX_ENABLED,
                               false)) {
-                s.slaves_tx_enable[s.n_slaves_tx_enable++] = iface->ofp_port;
+                s->slaves_tx_enable[s->n_slaves_tx_enable++] = iface->ofp_port;
             }
         } else {
             /* Port has only one interface and not running LACP.
              * Need to destroy LAG in h/w if it was created.
              * E.g. static LAG previously with 2 or more interfaces
              * now only has 1 interface need to have LAG destroyed. */
-            s.hw_bond_should_exist = false;
-            s.slaves[s.n_slaves++] = iface->ofp_port;
+            s->hw_bond_should_exist = false;
+            s->slaves[s->n_slaves++] = iface->ofp_port;
         }
 #endif
     }
 #ifdef OPS
     VLOG_DBG("port %s has %d configured interfaces, %d eligible "
              "interfaces, lacp_enabled=%d",
-             s.name, cfg_slave_count, (int)s.n_slaves, lacp_enabled);
-    s.bond_handle_alloc_only = false;
-    if (s.hw_bond_should_exist && (s.n_slaves < 1)) {
+             s->name, cfg_slave_count, (int)s->n_slaves, lacp_enabled);
+    s->bond_handle_alloc_only = false;
+    if (s->hw_bond_should_exist && (s->n_slaves < 1)) {
         if (port->bond_hw_handle == -1) {
-            s.bond_handle_alloc_only = true;
+            s->bond_handle_alloc_only = true;
         }
     }
 #endif
     /* Get VLAN tag. */
-    s.vlan = -1;
+    s->vlan = -1;
 
     int vlan_tag = -1;
     if(cfg->vlan_tag) {
@@ -1726,107 +2768,132 @@ port_configure(struct port *port)
 #else
     if (cfg->vlan_tag && vlan_tag >= 0 && vlan_tag <= 4095) {
 #endif
-        s.vlan = vlan_tag;
+        s->vlan = vlan_tag;
     }
-    VLOG_DBG("Configure port %s on vlan %d", s.name, s.vlan);
+    VLOG_DBG("Configure port %s on vlan %d", s->name, s->vlan);
 
     /* Get VLAN trunks. */
-    s.trunks = NULL;
+    s->trunks = NULL;
     if (cfg->n_vlan_trunks) {
         int index;
-        int64_t *vlan_trunks = xmalloc(sizeof(int64_t)*(cfg->n_vlan_trunks));
+
+        s->trunks = bitmap_allocate(4096);
         for (index = 0; index < cfg->n_vlan_trunks; index++) {
-            vlan_trunks[index] = ops_port_get_trunks(cfg, index);
+            int64_t vid = ops_port_get_trunks(cfg, index);
+
+            if (vid >= 0 && vid < 4096) {
+                bitmap_set1(s->trunks, vid);
+            }
         }
-        s.trunks = vlan_bitmap_from_array(vlan_trunks, cfg->n_vlan_trunks);
-        free(vlan_trunks);
     }
 
     /* Get VLAN mode. */
     if (cfg->vlan_mode) {
         if (!strcmp(cfg->vlan_mode, "access")) {
-            s.vlan_mode = PORT_VLAN_ACCESS;
+            s->vlan_mode = PORT_VLAN_ACCESS;
         } else if (!strcmp(cfg->vlan_mode, "trunk")) {
-            s.vlan_mode = PORT_VLAN_TRUNK;
+            s->vlan_mode = PORT_VLAN_TRUNK;
         } else if (!strcmp(cfg->vlan_mode, "native-tagged")) {
-            s.vlan_mode = PORT_VLAN_NATIVE_TAGGED;
+            s->vlan_mode = PORT_VLAN_NATIVE_TAGGED;
         } else if (!strcmp(cfg->vlan_mode, "native-untagged")) {
-            s.vlan_mode = PORT_VLAN_NATIVE_UNTAGGED;
+            s->vlan_mode = PORT_VLAN_NATIVE_UNTAGGED;
         } else {
             /* This "can't happen" because ovsdb-server should prevent it. */
             VLOG_WARN("port %s: unknown VLAN mode %s, falling "
                       "back to trunk mode", port->name, cfg->vlan_mode);
-            s.vlan_mode = PORT_VLAN_TRUNK;
+            s->vlan_mode = PORT_VLAN_TRUNK;
         }
     } else {
-        if (s.vlan >= 0) {
-            s.vlan_mode = PORT_VLAN_ACCESS;
+        if (s->vlan >= 0) {
+            s->vlan_mode = PORT_VLAN_ACCESS;
             if (cfg->n_vlan_trunks) {
                 VLOG_WARN("port %s: ignoring trunks in favor of implicit vlan",
                           port->name);
             }
         } else {
-            s.vlan_mode = PORT_VLAN_TRUNK;
+            s->vlan_mode = PORT_VLAN_TRUNK;
         }
     }
 #ifdef OPS
     /* If port is in TRUNK mode, VLAN tag needs to be ignored. */
-    if (s.vlan_mode == PORT_VLAN_TRUNK) {
-        s.vlan = -1;
+    if (s->vlan_mode == PORT_VLAN_TRUNK) {
+        s->vlan = -1;
     }
 #endif
-    s.use_priority_tags = smap_get_bool(&cfg->other_config, "priority-tags",
-                                        false);
+    s->use_priority_tags = smap_get_bool(&cfg->other_config, "priority-tags",
+                                         false);
 
 /* For OPS, LACP support is handled by lacpd. */
 #ifndef OPS
     /* Get LACP settings. */
-    s.lacp = port_configure_lacp(port, &lacp_settings);
-    if (s.lacp) {
+    s->lacp = port_configure_lacp(port, &prep->lacp_settings);
+    if (s->lacp) {
         size_t i = 0;
 
-        s.lacp_slaves = xmalloc(s.n_slaves * sizeof *s.lacp_slaves);
+        s->lacp_slaves = xmalloc(s->n_slaves * sizeof *s->lacp_slaves);
         LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-            iface_configure_lacp(iface, &s.lacp_slaves[i++]);
+            iface_configure_lacp(iface, &s->lacp_slaves[i++]);
         }
     } else {
-        s.lacp_slaves = NULL;
+        s->lacp_slaves = NULL;
     }
 #endif
 
     /* Get bond settings. */
 #ifdef OPS
-    if (s.hw_bond_should_exist) {
+    if (s->hw_bond_should_exist) {
 #else
-    if (s.n_slaves > 1) {
+    if (s->n_slaves > 1) {
 #endif
-        s.bond = &bond_settings;
-        port_configure_bond(port, &bond_settings);
+        s->bond = &prep->bond_settings;
+        prep->miimon_interval = port_configure_bond(port,
+                                                    &prep->bond_settings);
     } else {
-        s.bond = NULL;
-        LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-            netdev_set_miimon_interval(iface->netdev, 0);
-        }
+        s->bond = NULL;
+        prep->miimon_interval = 0;
     }
 
 #ifdef OPS_TEMP
     /* Setup port configuration option array and save
        its address in bundle setting */
-    s.port_options[PORT_OPT_VLAN] = &cfg->vlan_options;
-    s.port_options[PORT_OPT_BOND] = &cfg->bond_options;
-    s.port_options[PORT_HW_CONFIG] = &cfg->hw_config;
-    s.port_options[PORT_OTHER_CONFIG] = &cfg->other_config;
+    s->port_options[PORT_OPT_VLAN] = &cfg->vlan_options;
+    s->port_options[PORT_OPT_BOND] = &cfg->bond_options;
+    s->port_options[PORT_HW_CONFIG] = &cfg->hw_config;
+    s->port_options[PORT_OTHER_CONFIG] = &cfg->other_config;
 #endif
 
 #ifdef OPS
     /* Check for port L3 ip changes */
-    vrf_port_reconfig_ipaddr(port, &s);
+    vrf_port_reconfig_ipaddr(port, s);
+    ds_init(&prep->bundle_key);
+    port_bundle_key(s, &prep->bundle_key);
+#endif
+}
+
+/* Pushes the settings of 'port' prepared in 'prep' to ofproto. */
+static void
+port_apply(struct port *port, const struct port_prep *prep)
+{
+    const struct ofproto_bundle_settings *s = &prep->s;
+    struct iface *iface;
+#ifdef OPS
+    int prev_bond_handle = port->bond_hw_handle;
 #endif
 
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        netdev_set_miimon_interval(iface->netdev, prep->miimon_interval);
+    }
+
     /* Register. */
-    ofproto_bundle_register(port->bridge->ofproto, port, &s);
 #ifdef OPS
-    ofproto_bundle_get(port->bridge->ofproto, port, &port->bond_hw_handle);
+    if (port_bundle_changed(port, s, &prep->bundle_key)) {
+        ofproto_bundle_register(port->bridge->ofproto, port, s);
+        ofproto_bundle_get(port->bridge->ofproto, port,
+                           &port->bond_hw_handle);
+    } else {
+        COVERAGE_INC(bridge_port_register_skip);
+        VLOG_DBG("port %s: bundle settings unchanged", port->name);
+    }
     if (prev_bond_handle != port->bond_hw_handle) {
         struct smap smap;
 
@@ -1843,17 +2910,42 @@ port_configure(struct port *port)
         ovsrec_port_set_status(port->cfg, &smap);
         smap_destroy(&smap);
     }
+#else
+    ofproto_bundle_register(port->bridge->ofproto, port, s);
 #endif
-    /* Clean up. */
-    free(s.slaves);
+}
+
+static void
+port_prep_destroy(struct port_prep *prep)
+{
+    free(prep->s.slaves);
 #ifdef OPS
-    free(s.slaves_tx_enable);
+    free(prep->s.slaves_tx_enable);
+    ds_destroy(&prep->bundle_key);
+#endif
+    free(prep->s.trunks);
+#ifndef OPS
+    free(prep->s.lacp_slaves);
 #endif
-    free(s.trunks);
+}
+
 #ifndef OPS
-    free(s.lacp_slaves);
+static void
+port_configure(struct port *port)
+{
+    struct port_prep prep;
+
+#ifndef OPS_TEMP
+    if (port->cfg->vlan_mode && !strcmp(port->cfg->vlan_mode, "splinter")) {
+        configure_splinter_port(port);
+        return;
+    }
 #endif
+    port_prepare(port, &prep);
+    port_apply(port, &prep);
+    port_prep_destroy(&prep);
 }
+#endif
 
 /* Pick local port hardware address and datapath ID for 'br'. */
 static void
@@ -2577,7 +3669,7 @@ trim:
     return;
 }
 
-/* Prepare list of ports on which sFlow is enabled. */
+/* Prepare list of ports on which sFlow is disabled. */
 static void
 sflow_ports_disabled(struct sset *ports_list)
 {
@@ -2609,6 +3701,311 @@ sflow_ports_disabled(struct sset *ports_list)
         }
     }
 }
+
+/* The agent address and the ports with sFlow disabled come from scans of the
+ * Port table.  They are the same for every bridge and VRF, so they are kept
+ * here and only computed again when the Port, sFlow or System table changed
+ * since the last scan. */
+static struct sset sflow_disabled_ports
+    = SSET_INITIALIZER(&sflow_disabled_ports);
+
+/* Sampling rate last passed to ofproto, with the governor applied. */
+static uint32_t sflow_applied_rate;
+
+/* Content of the sFlow statistics column, so that the CLI shows the sFlow
+ * totals by reading a single row. */
+struct sflow_status {
+    int64_t sampling_rate;      /* Effective sampling rate. */
+    int64_t ingress_packets;    /* Samples of every interface. */
+    int64_t egress_packets;
+    int64_t ingress_rate;       /* Samples per second. */
+    int64_t egress_rate;
+};
+
+static struct sflow_status sflow_status;
+static bool sflow_status_published;     /* 'sflow_status' is in the DB. */
+static long long int sflow_status_msec; /* When the totals were read. */
+static long long int sflow_status_timer = LLONG_MIN;
+static char sflow_agent_ip[INET6_ADDRSTRLEN];
+static bool sflow_cache_valid;
+static unsigned int sflow_cache_seqno;
+
+static void
+sflow_cache_refresh(const struct ovsrec_sflow *cfg)
+{
+    if (sflow_cache_valid
+        && (sflow_cache_seqno == idl_seqno
+            || !(reconfigure_dirty
+                 & (NODE(PORTS) | NODE(SFLOW) | NODE(SYSTEM))))) {
+        return;
+    }
+
+    COVERAGE_INC(bridge_sflow_cache_refresh);
+    sflow_ports_disabled(&sflow_disabled_ports);
+    memset(sflow_agent_ip, 0, sizeof sflow_agent_ip);
+    sflow_agent_address(cfg->agent, cfg->agent_addr_family, sflow_agent_ip);
+    sflow_cache_valid = true;
+    sflow_cache_seqno = idl_seqno;
+}
+
+/* Copies into 'dst' the sFlow options 'src', which may point into the IDL. */
+static void
+sflow_options_clone(struct ofproto_sflow_options *dst,
+                    const struct ofproto_sflow_options *src)
+{
+    *dst = *src;
+    sset_clone(&dst->targets, &src->targets);
+    sset_clone(&dst->ports, &src->ports);
+    dst->agent_device = src->agent_device ? xstrdup(src->agent_device) : NULL;
+}
+
+static void
+sflow_options_destroy(struct ofproto_sflow_options *oso)
+{
+    sset_destroy(&oso->targets);
+    sset_destroy(&oso->ports);
+    free(oso->agent_device);
+}
+
+/* Returns true if the sFlow options 'a' and 'b' are the same.  Every option
+ * filled in by bridge_configure_sflow() must be compared. */
+static bool
+sflow_options_equal(const struct ofproto_sflow_options *a,
+                    const struct ofproto_sflow_options *b)
+{
+    return (sset_equals(&a->targets, &b->targets)
+            && sset_equals(&a->ports, &b->ports)
+            && a->sampling_rate == b->sampling_rate
+            && a->polling_interval == b->polling_interval
+            && a->header_len == b->header_len
+            && a->sub_id == b->sub_id
+            && a->max_datagram == b->max_datagram
+            && !strcmp(a->agent_device ? a->agent_device : "",
+                       b->agent_device ? b->agent_device : "")
+            && !strcmp(a->agent_ip, b->agent_ip));
+}
+
+/* Returns true if 'br' has exactly the ports named in 'names'. */
+static bool
+bridge_has_ports(const struct bridge *br, const struct sset *names)
+{
+    const struct port *port;
+
+    if (hmap_count(&br->ports) != sset_count(names)) {
+        return false;
+    }
+    HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+        if (!sset_contains(names, port->name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Frees the copy of the sFlow options last applied to 'br'. */
+static void
+bridge_forget_sflow(struct bridge *br)
+{
+    if (br->sflow_enabled) {
+        sflow_options_destroy(&br->sflow_options);
+        sset_destroy(&br->sflow_ports);
+        br->sflow_enabled = false;
+    }
+    br->sflow_set = false;
+}
+
+/* Passes 'oso' to ofproto_set_sflow() for 'br', or disables sFlow if 'oso' is
+ * NULL, unless the same options are already applied.  A provider may program
+ * sFlow on the ports the bridge has when the options are set, so a change in
+ * the ports of 'br' applies them again. */
+static void
+bridge_set_sflow(struct bridge *br, const struct ofproto_sflow_options *oso)
+{
+    const struct port *port;
+
+    if (br->sflow_set && br->sflow_enabled == (oso != NULL)
+        && (!oso
+            || (sflow_options_equal(&br->sflow_options, oso)
+                && bridge_has_ports(br, &br->sflow_ports)))) {
+        COVERAGE_INC(bridge_sflow_skip);
+        return;
+    }
+
+    ofproto_set_sflow(br->ofproto, oso);
+    bridge_forget_sflow(br);
+    br->sflow_set = true;
+    if (oso) {
+        sflow_options_clone(&br->sflow_options, oso);
+        sset_init(&br->sflow_ports);
+        HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+            sset_add(&br->sflow_ports, port->name);
+        }
+        br->sflow_enabled = true;
+    }
+}
+
+/* Applies the sFlow options again to every bridge and VRF, in the order
+ * bridge_reconfigure() numbers them, after the effective sampling rate
+ * changed. */
+static void
+bridge_reapply_sflow(void)
+{
+    const struct ovsrec_system *system_row = ovsrec_system_first(idl);
+    int sflow_bridge_number = 0;
+    struct bridge *br;
+    struct vrf *vrf;
+
+    if (!system_row || !system_row->sflow) {
+        return;
+    }
+    HMAP_FOR_EACH (br, node, &all_bridges) {
+        bridge_configure_sflow(br, system_row->sflow, &sflow_bridge_number);
+    }
+    HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+        bridge_configure_sflow(vrf->up, system_row->sflow,
+                               &sflow_bridge_number);
+    }
+}
+
+static void
+sflow_status_write(struct ovsdb_idl_txn *txn OVS_UNUSED,
+                   void *aux OVS_UNUSED)
+{
+#define SFLOW_STATUS                                            \
+    SFLOW_STAT(sampling_rate,   "effective_sampling_rate")      \
+    SFLOW_STAT(ingress_packets, "sflow_ingress_packets")        \
+    SFLOW_STAT(egress_packets,  "sflow_egress_packets")         \
+    SFLOW_STAT(ingress_rate,    "sflow_ingress_packets_per_sec") \
+    SFLOW_STAT(egress_rate,     "sflow_egress_packets_per_sec")
+
+#define SFLOW_STAT(MEMBER, NAME) NAME,
+    static const char *const names[] = { SFLOW_STATUS };
+#undef SFLOW_STAT
+    const struct ovsrec_system *system_row = ovsrec_system_first(idl);
+    const struct ovsrec_sflow *sflow;
+    int64_t *values;
+    char **keys;
+    size_t n, i, j;
+
+    if (!system_row || !system_row->sflow) {
+        return;
+    }
+    sflow = system_row->sflow;
+
+    /* The column is shared with other writers, so keep their keys.  If it
+     * changes before the commit, the transaction fails and sflow_status_done()
+     * publishes the totals again. */
+    ovsrec_sflow_verify_statistics(sflow);
+    keys = xmalloc((sflow->n_statistics + ARRAY_SIZE(names)) * sizeof *keys);
+    values = xmalloc((sflow->n_statistics + ARRAY_SIZE(names))
+                     * sizeof *values);
+    n = 0;
+    for (i = 0; i < sflow->n_statistics; i++) {
+        for (j = 0; j < ARRAY_SIZE(names); j++) {
+            if (!strcmp(sflow->key_statistics[i], names[j])) {
+                break;
+            }
+        }
+        if (j == ARRAY_SIZE(names)) {
+            keys[n] = sflow->key_statistics[i];
+            values[n] = sflow->value_statistics[i];
+            n++;
+        }
+    }
+
+#define SFLOW_STAT(MEMBER, NAME)                \
+    keys[n] = NAME;                             \
+    values[n] = sflow_status.MEMBER;            \
+    n++;
+    SFLOW_STATUS;
+#undef SFLOW_STAT
+#undef SFLOW_STATUS
+    ovsrec_sflow_set_statistics(sflow, keys, values, n);
+    sflow_status_published = true;
+    free(keys);
+    free(values);
+}
+
+static void
+sflow_status_done(enum ovsdb_idl_txn_status status, void *aux OVS_UNUSED)
+{
+    if (status != TXN_SUCCESS && status != TXN_UNCHANGED) {
+        /* Publish it again on the next run. */
+        sflow_status_published = false;
+    }
+}
+
+static struct txn_writer sflow_status_writer =
+    TXN_WRITER_INITIALIZER("sflow-status", sflow_status_write,
+                           sflow_status_done, NULL);
+
+/* Returns the rate per second of a counter that went from 'old' to 'new' in
+ * 'msec'. */
+static int64_t
+sflow_status_rate(int64_t old, int64_t new, long long int msec)
+{
+    return new > old && msec > 0 ? (new - old) * 1000 / msec : 0;
+}
+
+/* Reads the sFlow totals of the interfaces into 'sflow_status' and derives
+ * the sample rates from the previous reading. */
+static void
+sflow_status_update_totals(long long int now)
+{
+    struct subsystem_sflow_stats totals;
+    struct sflow_status new = sflow_status;
+
+    subsystem_get_sflow_stats(&totals);
+    new.ingress_packets = totals.ingress_packets;
+    new.egress_packets = totals.egress_packets;
+    if (sflow_status_msec) {
+        long long int elapsed = now - sflow_status_msec;
+
+        new.ingress_rate = sflow_status_rate(sflow_status.ingress_packets,
+                                             new.ingress_packets, elapsed);
+        new.egress_rate = sflow_status_rate(sflow_status.egress_packets,
+                                            new.egress_packets, elapsed);
+    }
+    sflow_status_msec = now;
+
+    if (memcmp(&new, &sflow_status, sizeof new)) {
+        sflow_status = new;
+        sflow_status_published = false;
+    }
+}
+
+/* Runs the sampling governor and publishes the sampling rate in effect with
+ * the sample totals, once per statistics interval. */
+static void
+run_sflow_update(void)
+{
+    const struct ovsrec_system *system_row = ovsrec_system_first(idl);
+    long long int now = time_msec();
+
+    if (sflow_governor_run()) {
+        bridge_reapply_sflow();
+    }
+
+    if (!system_row || !system_row->sflow) {
+        sflow_status_published = false;
+        sflow_status_msec = 0;
+        return;
+    }
+
+    if (sflow_status.sampling_rate != sflow_applied_rate) {
+        sflow_status.sampling_rate = sflow_applied_rate;
+        sflow_status_published = false;
+    }
+    if (now >= sflow_status_timer) {
+        sflow_status_update_totals(now);
+        sflow_status_timer = now + stats_class_interval(STATS_CLASS_NORMAL);
+    }
+
+    if (!sflow_status_published
+        && !txn_writer_is_busy(&sflow_status_writer)) {
+        txn_writer_request(&sflow_status_writer);
+    }
+}
 #endif
 
 /* Set sFlow configuration on 'br'. */
@@ -2627,25 +4024,37 @@ bridge_configure_sflow(struct bridge *br, int *sflow_bridge_number)
     size_t i;
 #endif
     struct ofproto_sflow_options oso;
-    const struct ovsrec_port *port_row;
 
     if (!cfg) {
         VLOG_DBG("%s:%d, disable sflow config", __FUNCTION__, __LINE__);
 
+#ifdef OPS
+        bridge_set_sflow(br, NULL);
+#else
         ofproto_set_sflow(br->ofproto, NULL);
+#endif
         return;
     }
 
     memset(&oso, 0, sizeof oso);
 
     sset_init(&oso.targets);
+#ifdef OPS
+    sflow_cache_refresh(cfg);
+    sset_clone(&oso.ports, &sflow_disabled_ports);
+#else
     sset_init(&oso.ports);
+#endif
     sset_add_array(&oso.targets, cfg->targets, cfg->n_targets);
 
     oso.sampling_rate = SFL_DEFAULT_SAMPLING_RATE;
     if (cfg->sampling) {
         oso.sampling_rate = *cfg->sampling;
     }
+#ifdef OPS
+    oso.sampling_rate = sflow_governor_rate(oso.sampling_rate);
+    sflow_applied_rate = oso.sampling_rate;
+#endif
 
     oso.polling_interval = SFL_DEFAULT_POLLING_INTERVAL;
     if (cfg->polling) {
@@ -2661,13 +4070,11 @@ bridge_configure_sflow(struct bridge *br, int *sflow_bridge_number)
     oso.agent_device = cfg->agent;
 
 #ifdef OPS
-    sflow_agent_address(cfg->agent, cfg->agent_addr_family, oso.agent_ip);
+    ovs_strlcpy(oso.agent_ip, sflow_agent_ip, sizeof oso.agent_ip);
     oso.max_datagram = SFL_DEFAULT_DATAGRAM_SIZE;
     if (cfg->max_datagram) {
         oso.max_datagram = *cfg->max_datagram;
     }
-
-    sflow_ports_disabled(&oso.ports);
 #endif
 
 #ifndef OPS
@@ -2680,8 +4087,13 @@ bridge_configure_sflow(struct bridge *br, int *sflow_bridge_number)
         }
     }
 #endif
+#ifdef OPS
+    bridge_set_sflow(br, &oso);
+#else
     ofproto_set_sflow(br->ofproto, &oso);
+#endif
     sset_destroy(&oso.targets);
+    sset_destroy(&oso.ports);
 }
 
 static void
@@ -2934,12 +4346,35 @@ iface_create(struct bridge *br, const struct ovsrec_interface *iface_cfg,
     list_push_back(&port->ifaces, &iface->port_elem);
     hmap_insert(&br->iface_by_name, &iface->name_node,
                 hash_string(iface_cfg->name, 0));
+#ifdef OPS
+    hmap_insert(&all_ifaces_by_name, &iface->global_node,
+                hash_string(iface_cfg->name, 0));
+#endif
     iface->port = port;
     iface->name = xstrdup(iface_cfg->name);
     iface->ofp_port = ofp_port;
+#ifdef OPS
+    port_bundle_forget(port);
+#endif
     iface->netdev = netdev;
     iface->type = iface_get_type(iface_cfg, br->cfg);
     iface->cfg = iface_cfg;
+#ifdef OPS
+    iface->rate = iface_rate_create();
+    if (!strcmp(iface_cfg->type, OVSREC_INTERFACE_TYPE_VLANSUBINT)) {
+        /* Configured by iface_do_create(). */
+        iface_subintf_applied(iface);
+    } else {
+        iface_subintf_parent_changed(iface->name, true);
+    }
+#endif
+#ifdef OPS_TEMP
+    if (iface_has_bridge_status(iface)) {
+        list_push_back(&status_ifaces, &iface->status_elem);
+    } else {
+        list_init(&iface->status_elem);
+    }
+#endif
     hmap_insert(&br->ifaces, &iface->ofp_port_node,
                 hash_ofp_port(ofp_port));
 
@@ -2954,6 +4389,7 @@ iface_create(struct bridge *br, const struct ovsrec_interface *iface_cfg,
         sblk.br = br;
         sblk.netdev = iface->netdev;
         sblk.cfg = iface_cfg;
+        sblk.rates = iface_rate_get(iface->rate);
         execute_stats_block(&sblk, STATS_BRIDGE_CREATE_NETDEV);
     }
 #endif
@@ -3273,6 +4709,19 @@ dpid_from_hash(const void *data, size_t n)
     return eth_addr_to_uint64(hash.ea);
 }
 
+#ifdef OPS
+/* Returns true if the status of 'iface' is maintained by bridge.c.  The
+ * status of system and loopback interfaces is updated from subsystem.c. */
+static bool
+iface_has_bridge_status(const struct iface *iface)
+{
+    return (!iface_is_synthetic(iface)
+            && iface->type
+            && strcmp(iface->type, OVSREC_INTERFACE_TYPE_SYSTEM)
+            && strcmp(iface->type, OVSREC_INTERFACE_TYPE_LOOPBACK));
+}
+#endif
+
 static void
 iface_refresh_netdev_status(struct iface *iface)
 {
@@ -3295,9 +4744,7 @@ iface_refresh_netdev_status(struct iface *iface)
 
 #ifdef OPS
     /* Interface status is updated from subsystem.c. */
-    if (!iface->type
-        || (!strcmp(iface->type, OVSREC_INTERFACE_TYPE_SYSTEM))
-        || (!strcmp(iface->type, OVSREC_INTERFACE_TYPE_LOOPBACK))) {
+    if (!iface_has_bridge_status(iface)) {
         return;
     }
 #endif
@@ -3536,8 +4983,13 @@ iface_refresh_stats(struct iface *iface)
 #define IFACE_STAT(MEMBER, NAME) + 1
     enum { N_IFACE_STATS = IFACE_STATS };
 #undef IFACE_STAT
+#ifdef OPS
+    int64_t values[N_IFACE_STATS + IFACE_RATE_N_KEYS];
+    char *keys[N_IFACE_STATS + IFACE_RATE_N_KEYS];
+#else
     int64_t values[N_IFACE_STATS];
     char *keys[N_IFACE_STATS];
+#endif
     int n;
 
     struct netdev_stats stats;
@@ -3563,12 +5015,18 @@ iface_refresh_stats(struct iface *iface)
 #undef IFACE_STAT
     ovs_assert(n <= N_IFACE_STATS);
 
+#ifdef OPS
+    /* Publish the smoothed rates next to the raw counters. */
+    iface_rate_update(iface->rate, &stats, iface->cfg);
+    n += iface_rate_put_stats(iface->rate, &keys[n], &values[n]);
+#endif
+
     ovsrec_interface_set_statistics(iface->cfg, keys, values, n);
 #undef IFACE_STATS
 }
 
-static void
-br_refresh_datapath_info(struct bridge *br)
+static const char *
+br_get_datapath_version(const struct bridge *br)
 {
     const char *version;
 
@@ -3576,8 +5034,21 @@ br_refresh_datapath_info(struct bridge *br)
                ? br->ofproto->ofproto_class->get_datapath_version(br->ofproto)
                : NULL);
 
-    ovsrec_bridge_set_datapath_version(br->cfg,
-                                       version ? version : "<unknown>");
+    return version ? version : "<unknown>";
+}
+
+/* Returns true if the datapath version in 'br''s database record is stale. */
+static bool
+br_datapath_info_changed(const struct bridge *br)
+{
+    return (!br->cfg->datapath_version
+            || strcmp(br->cfg->datapath_version, br_get_datapath_version(br)));
+}
+
+static void
+br_refresh_datapath_info(struct bridge *br)
+{
+    ovsrec_bridge_set_datapath_version(br->cfg, br_get_datapath_version(br));
 }
 
 #ifndef OPS_TEMP
@@ -3813,6 +5284,44 @@ reconfigure_system_stats(const struct ovsrec_open_vswitch *cfg)
     }
 }
 
+/* Writes the system statistics 'stats' into the open transaction, taking
+ * ownership of them. */
+static void
+system_stats_write(struct smap *stats)
+{
+    const struct ovsrec_open_vswitch *cfg = ovsrec_open_vswitch_first(idl);
+
+    if (cfg) {
+        struct ovsdb_datum datum;
+
+        ovsdb_datum_from_smap(&datum, stats);
+        ovsdb_idl_txn_write(&cfg->header_, &ovsrec_open_vswitch_col_statistics,
+                            &datum);
+    } else {
+        smap_destroy(stats);
+    }
+    free(stats);
+}
+
+#ifdef OPS
+/* Latest system statistics not yet written to the database. */
+static struct smap *system_stats;
+
+static void
+system_stats_writer_write(struct ovsdb_idl_txn *txn OVS_UNUSED,
+                          void *aux OVS_UNUSED)
+{
+    if (system_stats) {
+        system_stats_write(system_stats);
+        system_stats = NULL;
+    }
+}
+
+static struct txn_writer system_stats_writer =
+    TXN_WRITER_INITIALIZER("system-stats", system_stats_writer_write, NULL,
+                           NULL);
+#endif
+
 static void
 run_system_stats(void)
 {
@@ -3821,17 +5330,22 @@ run_system_stats(void)
 
     stats = system_stats_run();
     if (stats && cfg) {
+#ifdef OPS
+        /* A newer sample replaces one that was not written yet. */
+        if (system_stats) {
+            smap_destroy(system_stats);
+            free(system_stats);
+        }
+        system_stats = stats;
+        txn_writer_request(&system_stats_writer);
+#else
         struct ovsdb_idl_txn *txn;
-        struct ovsdb_datum datum;
 
         txn = ovsdb_idl_txn_create(idl);
-        ovsdb_datum_from_smap(&datum, stats);
-        ovsdb_idl_txn_write(&cfg->header_, &ovsrec_open_vswitch_col_statistics,
-                            &datum);
+        system_stats_write(stats);
         ovsdb_idl_txn_commit(txn);
         ovsdb_idl_txn_destroy(txn);
-
-        free(stats);
+#endif
     }
 }
 
@@ -3885,192 +5399,539 @@ refresh_controller_status(void)
     ofproto_free_ofproto_controller_info(&info);
 }
 
-/* Update interface and mirror statistics if necessary. */
+/* Returns true if the statistics of 'iface' are due at 'now', according to
+ * its polling class, and remembers the answer for the stats blocks. */
+static bool
+iface_stats_due(struct iface *iface, long long int now)
+{
+#ifdef OPS
+    enum stats_class class = stats_class_get(iface->cfg, iface->port->cfg);
+
+    /* The counters of system interfaces are polled by subsystem.c, which
+     * paces its own timer on their class. */
+    if (iface->type && strcmp(iface->type, "system")) {
+        stats_next_class = MIN(stats_next_class, class);
+    }
+    iface->stats_refreshed = stats_class_due(&iface->stats_due, class, now,
+                                             stats_timer_interval / 2);
+    return iface->stats_refreshed;
+#else
+    return true;
+#endif
+}
+
+/* Returns true if 'port' is collected in statistics slice 'slice'. */
+static bool
+stats_port_in_slice(const struct port *port, int slice)
+{
+    return stats_n_slices <= 1
+           || hash_string(port->name, 0) % stats_n_slices == slice;
+}
+
+#ifdef OPS
+/* Returns true if the statistics of any interface of 'port' were refreshed
+ * by the current statistics slice. */
+static bool
+port_stats_refreshed(const struct port *port)
+{
+    struct iface *iface;
+
+    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+        if (iface->stats_refreshed) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+/* Fetches the statistics of the ports that belong to 'slice' and runs the
+ * statistics-gathering callbacks for them.  Only interfaces whose polling
+ * class is due are visited.  Bridge-wide work (mirrors, controller status
+ * and the per bridge/VRF blocks) is done in slice 0 once per normal
+ * interval, and STATS_BEGIN/STATS_END bracket the whole cycle.  Returns the
+ * number of interfaces visited. */
+static unsigned int
+run_stats_slice(int slice)
+{
+    long long int now = time_msec();
+    unsigned int n_ifaces = 0;
+    bool bridge_round = !slice;
+    struct bridge *br;
+#ifdef OPS
+    struct vrf *vrf;
+
+    if (!slice) {
+        stats_bridge_round = stats_class_due(&stats_bridge_due,
+                                             STATS_CLASS_NORMAL, now,
+                                             stats_timer_interval / 2);
+    }
+    bridge_round = !slice && stats_bridge_round;
+#endif
+
+    HMAP_FOR_EACH (br, node, &all_bridges) {
+        struct port *port;
+        struct mirror *m;
+        HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+            struct iface *iface;
+
+            if (!stats_port_in_slice(port, slice)) {
+                continue;
+            }
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                if (iface_stats_due(iface, now)) {
+                    iface_refresh_stats(iface);
+                    n_ifaces++;
+                }
+            }
+#ifndef OPS_TEMP
+            port_refresh_stp_stats(port);
+#endif
+        }
+        if (bridge_round) {
+            HMAP_FOR_EACH (m, hmap_node, &br->mirrors) {
+                mirror_refresh_stats(m);
+            }
+        }
+    }
+
+#ifdef OPS
+    HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+        struct port *port;
+        HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
+            struct iface *iface;
+
+            if (!stats_port_in_slice(port, slice)) {
+                continue;
+            }
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                if (iface_stats_due(iface, now)) {
+                    iface_refresh_stats(iface);
+                    n_ifaces++;
+                }
+            }
+        }
+    }
+#endif
+
+    if (bridge_round) {
+        refresh_controller_status();
+    }
+
+#ifdef OPS
+    /* Now execute any registered statistics-gathering callbacks. */
+    struct stats_blk_params sblk = {0};
+
+    sblk.idl = idl;
+    sblk.idl_seqno = idl_seqno;
+    if (!slice) {
+        execute_stats_block(&sblk, STATS_BEGIN);
+    }
+    HMAP_FOR_EACH (br, node, &all_bridges) {
+        struct port *port;
+        sblk.br = br;
+        if (bridge_round) {
+            execute_stats_block(&sblk, STATS_PER_BRIDGE);
+        }
+        HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+            struct iface *iface;
+
+            if (!stats_port_in_slice(port, slice)
+                || !port_stats_refreshed(port)) {
+                continue;
+            }
+            sblk.port = port;
+            execute_stats_block(&sblk, STATS_PER_BRIDGE_PORT);
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                /* Statistics-callback for non-system interfaces.
+                   Note: system interfaces are handled in subsystem.c. */
+                if (iface->netdev != NULL && iface->stats_refreshed) {
+                    if (iface->type && strcmp(iface->type, "system")) {
+                        sblk.netdev = iface->netdev;
+                        sblk.cfg = iface->cfg;
+                        sblk.rates = iface_rate_get(iface->rate);
+                        execute_stats_block(&sblk, STATS_PER_BRIDGE_NETDEV);
+                    }
+                }
+            }
+        }
+    }
+
+    HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+        struct port *port;
+        sblk.vrf = vrf;
+        if (bridge_round) {
+            execute_stats_block(&sblk, STATS_PER_VRF);
+        }
+        HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
+            struct iface *iface;
+
+            if (!stats_port_in_slice(port, slice)
+                || !port_stats_refreshed(port)) {
+                continue;
+            }
+            sblk.port = port;
+            execute_stats_block(&sblk, STATS_PER_VRF_PORT);
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                /* Statistics-callback for non-system interfaces.
+                   Note: system interfaces are handled in subsystem.c. */
+                if (iface->netdev != NULL && iface->stats_refreshed) {
+                    if (iface->type && strcmp(iface->type, "system")) {
+                        sblk.netdev = iface->netdev;
+                        sblk.cfg = iface->cfg;
+                        sblk.rates = iface_rate_get(iface->rate);
+                        execute_stats_block(&sblk, STATS_PER_VRF_NETDEV);
+                    }
+                }
+            }
+        }
+    }
+    if (slice == stats_n_slices - 1) {
+        execute_stats_block(&sblk, STATS_END);
+    }
+#endif
+
+    return n_ifaces;
+}
+
+/* Collects the statistics slice 'stats_slice' into the open transaction. */
+static void
+stats_write(struct ovsdb_idl_txn *txn OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    struct stats_slice_timing *t = &stats_slice_timings[stats_slice];
+    long long int start;
+
+    if (!stats_slice) {
+        stats_cycle_start = time_msec();
+    }
+
+    start = time_usec();
+    t->n_ifaces = run_stats_slice(stats_slice);
+    t->last_usec = time_usec() - start;
+    t->max_usec = MAX(t->max_usec, t->last_usec);
+    t->total_usec += t->last_usec;
+    t->n_runs++;
+}
+
+/* Schedules the next slice once the transaction carrying the statistics
+ * completed, at its share of the interval.  After the last slice this is the
+ * start of the next cycle.  A slice whose transaction has to be retried is
+ * collected again right away. */
+static void
+stats_done(enum ovsdb_idl_txn_status status, void *aux OVS_UNUSED)
+{
+    if (stats_slice_reset) {
+        stats_slice_reset = false;
+        stats_slice = 0;
+        stats_timer = LLONG_MIN;
+        return;
+    }
+    if (status == TXN_TRY_AGAIN) {
+        stats_timer = LLONG_MIN;
+        return;
+    }
+
+    stats_slice = (stats_slice + 1) % stats_n_slices;
+#ifdef OPS
+    if (!stats_slice && !stats_published
+        && (status == TXN_SUCCESS || status == TXN_UNCHANGED)) {
+        stats_published = true;
+        startup_timeline_mark("first stats published");
+        bridge_startup_timeline_check();
+    }
+    if (!stats_slice) {
+        /* Pace the next cycle on the fastest class just seen. */
+        stats_cycle_class = stats_next_class;
+        stats_next_class = STATS_CLASS_NORMAL;
+        stats_timer_interval = stats_class_interval(stats_cycle_class);
+    }
+#endif
+    stats_timer = stats_cycle_start
+                  + (long long int) stats_timer_interval
+                    * (stats_slice ? stats_slice : stats_n_slices)
+                    / stats_n_slices;
+}
+
+#ifdef OPS
+static struct txn_writer stats_writer =
+    TXN_WRITER_INITIALIZER("bridge-stats", stats_write, stats_done, NULL);
+#endif
+
+/* Update interface and mirror statistics if necessary.
+ *
+ * The ports are split into 'stats_n_slices' slices that are collected at
+ * evenly spaced points of the statistics interval, each one in its own
+ * transaction, so that large configurations do not push every counter to
+ * the database in a single main loop iteration. */
 static void
 run_stats_update(void)
 {
-    static struct ovsdb_idl_txn *stats_txn;
     const struct ovsrec_open_vswitch *cfg = ovsrec_open_vswitch_first(idl);
     int stats_interval;
+    int n_slices;
 
     if (!cfg) {
         return;
     }
 
+#ifdef OPS
+    stats_class_configure(&cfg->other_config);
+    stats_interval = stats_class_interval(stats_cycle_class);
+#else
     /* Statistics update interval should always be greater than or equal to
      * 5000 ms. */
     stats_interval = MAX(smap_get_int(&cfg->other_config,
                                       "stats-update-interval",
                                       5000), 5000);
-    if (stats_timer_interval != stats_interval) {
+#endif
+    n_slices = smap_get_int(&cfg->other_config, "stats-update-slices",
+                            STATS_DFLT_SLICES);
+    n_slices = MIN(MAX(n_slices, 1), STATS_MAX_SLICES);
+    if (stats_n_slices != n_slices) {
+        memset(stats_slice_timings, 0, sizeof stats_slice_timings);
+    }
+    if (stats_timer_interval != stats_interval
+        || stats_n_slices != n_slices) {
         stats_timer_interval = stats_interval;
+        stats_n_slices = n_slices;
+        stats_slice = 0;
         stats_timer = LLONG_MIN;
+#ifdef OPS
+        stats_slice_reset = txn_writer_is_busy(&stats_writer);
+#endif
     }
+#ifdef OPS
+    iface_rate_set_default_window(&cfg->other_config);
 
+    /* Rate limit the update.  Do not start a new update if the previous one
+     * is not done.  The slice is written by the coalesced transaction at the
+     * end of this main loop iteration. */
+    if (time_msec() >= stats_timer && !txn_writer_is_busy(&stats_writer)) {
+        txn_writer_request(&stats_writer);
+    }
+#else
     if (time_msec() >= stats_timer) {
+        static struct ovsdb_idl_txn *stats_txn;
         enum ovsdb_idl_txn_status status;
 
         /* Rate limit the update.  Do not start a new update if the
          * previous one is not done. */
         if (!stats_txn) {
-            struct bridge *br;
+            stats_txn = ovsdb_idl_txn_create(idl);
+            stats_write(stats_txn, NULL);
+        }
+
+        status = ovsdb_idl_txn_commit(stats_txn);
+        if (status != TXN_INCOMPLETE) {
+            ovsdb_idl_txn_destroy(stats_txn);
+            stats_txn = NULL;
+            stats_done(status, NULL);
+        }
+    }
+#endif
+}
+
+static void
+bridge_unixctl_stats_slices(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                            const char *argv[] OVS_UNUSED,
+                            void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    int i;
+
+    ds_put_format(&ds, "interval: %d ms, slices: %d\n",
+                  stats_timer_interval, stats_n_slices);
+#ifdef OPS
+    for (i = 0; i < N_STATS_CLASSES; i++) {
+        ds_put_format(&ds, "class %s: %d ms%s\n", stats_class_to_string(i),
+                      stats_class_interval(i),
+                      i == stats_cycle_class ? " (cycle)" : "");
+    }
+#endif
+    ds_put_format(&ds, "%-6s %-8s %-12s %-12s %-12s %s\n", "slice", "ifaces",
+                  "last(us)", "max(us)", "avg(us)", "runs");
+    for (i = 0; i < stats_n_slices; i++) {
+        const struct stats_slice_timing *t = &stats_slice_timings[i];
+
+        ds_put_format(&ds, "%-6d %-8u %-12lld %-12lld %-12lld %llu\n",
+                      i, t->n_ifaces, t->last_usec, t->max_usec,
+                      t->n_runs ? t->total_usec / (long long int) t->n_runs
+                                : 0,
+                      t->n_runs);
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+#ifdef OPS_TEMP
+/* Returns true if the status of 'iface', a member of 'status_ifaces', needs
+ * to be written to the database. */
+static bool
+iface_status_is_dirty(const struct iface *iface)
+{
+    return (status_txn_try_again
+            || iface->change_seq != netdev_get_change_seq(iface->netdev));
+}
+
+/* Interfaces and bridges collected by status_collect_dirty() for the next
+ * status write. */
+static struct iface **status_dirty;
+static size_t status_n_dirty, status_allocated_dirty;
+static bool status_datapath_changed;
+
+/* Collects the interfaces and bridges whose status changed since the last
+ * update.  Returns false if there is nothing to write. */
+static bool
+status_collect_dirty(void)
+{
+    struct iface *iface;
+    struct bridge *br;
+
+    status_n_dirty = 0;
+    LIST_FOR_EACH (iface, status_elem, &status_ifaces) {
+        if (iface_status_is_dirty(iface)) {
+            if (status_n_dirty >= status_allocated_dirty) {
+                status_dirty = x2nrealloc(status_dirty,
+                                          &status_allocated_dirty,
+                                          sizeof *status_dirty);
+            }
+            status_dirty[status_n_dirty++] = iface;
+        }
+    }
 
+    status_datapath_changed = false;
+    HMAP_FOR_EACH (br, node, &all_bridges) {
+        if (br_datapath_info_changed(br)) {
+            status_datapath_changed = true;
+            break;
+        }
+    }
+
+    if (!status_n_dirty && !status_datapath_changed) {
+        COVERAGE_INC(bridge_status_skipped);
+        /* Nothing is left to retry. */
+        status_txn_try_again = false;
+        return false;
+    }
+    return true;
+}
+#endif
+
+/* Returns true if bridge/port/interface status must be written to the
+ * database, that is if the global connectivity sequence number changed or
+ * the previous update failed. */
+static bool
+status_update_needed(void)
+{
+    uint64_t seq = seq_read(connectivity_seq_get());
+
+    if (seq == connectivity_seqno && !status_txn_try_again) {
+        return false;
+    }
+    connectivity_seqno = seq;
 #ifdef OPS_TEMP
-            struct vrf *vrf;
-#endif
-            stats_txn = ovsdb_idl_txn_create(idl);
-            HMAP_FOR_EACH (br, node, &all_bridges) {
-                struct port *port;
-                struct mirror *m;
-                HMAP_FOR_EACH (port, hmap_node, &br->ports) {
-                    struct iface *iface;
-
-                    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        iface_refresh_stats(iface);
-                    }
-#ifndef OPS_TEMP
-                    port_refresh_stp_stats(port);
+    return status_collect_dirty();
+#else
+    return true;
 #endif
-                }
-                HMAP_FOR_EACH (m, hmap_node, &br->mirrors) {
-                    mirror_refresh_stats(m);
-                }
-            }
+}
 
-#ifdef OPS
-            HMAP_FOR_EACH (vrf, node, &all_vrfs) {
-                struct port *port;
-                HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
-                    struct iface *iface;
+/* Writes the bridge/port/interface status into the open transaction. */
+static void
+status_write(struct ovsdb_idl_txn *txn OVS_UNUSED, void *aux OVS_UNUSED)
+{
+#ifdef OPS_TEMP
+    struct bridge *br;
+    size_t i;
 
-                    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        iface_refresh_stats(iface);
-                    }
-                }
+    if (status_datapath_changed) {
+        HMAP_FOR_EACH (br, node, &all_bridges) {
+            if (br_datapath_info_changed(br)) {
+                br_refresh_datapath_info(br);
             }
+        }
+    }
+    for (i = 0; i < status_n_dirty; i++) {
+        iface_refresh_netdev_status(status_dirty[i]);
+        iface_refresh_ofproto_status(status_dirty[i]);
+    }
+    COVERAGE_ADD(bridge_status_iface_refresh, status_n_dirty);
+    status_n_dirty = 0;
+#else
+    struct bridge *br;
+#ifdef OPS
+    struct vrf *vrf;
 #endif
 
-            refresh_controller_status();
-
-
-#ifdef OPS
-            /* Now execute any registered statistics-gathering callbacks. */
-            struct stats_blk_params sblk = {0};
-
-            sblk.idl = idl;
-            sblk.idl_seqno = idl_seqno;
-            execute_stats_block(&sblk, STATS_BEGIN);
-            HMAP_FOR_EACH (br, node, &all_bridges) {
-                struct port *port;
-                sblk.br = br;
-                execute_stats_block(&sblk, STATS_PER_BRIDGE);
-                HMAP_FOR_EACH (port, hmap_node, &br->ports) {
-                    struct iface *iface;
-                    sblk.port = port;
-                    execute_stats_block(&sblk, STATS_PER_BRIDGE_PORT);
-                    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        /* Statistics-callback for non-system interfaces.
-                           Note: system interfaces are handled in subsystem.c. */
-                        if (iface->netdev != NULL) {
-                            if (iface->type && strcmp(iface->type, "system")) {
-                                sblk.netdev = iface->netdev;
-                                sblk.cfg = iface->cfg;
-                                execute_stats_block(&sblk, STATS_PER_BRIDGE_NETDEV);
-                            }
-                        }
-                    }
-                }
-            }
+    HMAP_FOR_EACH (br, node, &all_bridges) {
+        struct port *port;
 
-            HMAP_FOR_EACH (vrf, node, &all_vrfs) {
-                struct port *port;
-                sblk.vrf = vrf;
-                execute_stats_block(&sblk, STATS_PER_VRF);
-                HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
-                    struct iface *iface;
-                    sblk.port = port;
-                    execute_stats_block(&sblk, STATS_PER_VRF_PORT);
-                    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        /* Statistics-callback for non-system interfaces.
-                           Note: system interfaces are handled in subsystem.c. */
-                        if (iface->netdev != NULL) {
-                            if (iface->type && strcmp(iface->type, "system")) {
-                                sblk.netdev = iface->netdev;
-                                sblk.cfg = iface->cfg;
-                                execute_stats_block(&sblk, STATS_PER_VRF_NETDEV);
-                            }
-                        }
-                    }
-                }
+        br_refresh_stp_status(br);
+        br_refresh_rstp_status(br);
+        br_refresh_datapath_info(br);
+        HMAP_FOR_EACH (port, hmap_node, &br->ports) {
+            struct iface *iface;
+
+            port_refresh_stp_status(port);
+            port_refresh_rstp_status(port);
+            port_refresh_bond_status(port, status_txn_try_again);
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                iface_refresh_netdev_status(iface);
+                iface_refresh_ofproto_status(iface);
             }
-            execute_stats_block(&sblk, STATS_END);
-#endif
         }
+    }
 
-        status = ovsdb_idl_txn_commit(stats_txn);
-        if (status != TXN_INCOMPLETE) {
-            stats_timer = time_msec() + stats_timer_interval;
-            ovsdb_idl_txn_destroy(stats_txn);
-            stats_txn = NULL;
+#ifdef OPS
+    HMAP_FOR_EACH (vrf, node, &all_vrfs) {
+        struct port *port;
+
+        HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
+            struct iface *iface;
+
+            LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
+                iface_refresh_netdev_status(iface);
+                iface_refresh_ofproto_status(iface);
+            }
         }
     }
+#endif
+#endif /* OPS_TEMP */
 }
 
-/* Update bridge/port/interface status if necessary. */
+/* Sets the 'status_txn_try_again' if the transaction fails. */
 static void
-run_status_update(void)
+status_done(enum ovsdb_idl_txn_status status, void *aux OVS_UNUSED)
 {
-    if (!status_txn) {
-        uint64_t seq;
+    if (status == TXN_SUCCESS || status == TXN_UNCHANGED) {
+        status_txn_try_again = false;
+    } else {
+        status_txn_try_again = true;
+    }
+}
 
-        /* Rate limit the update.  Do not start a new update if the
-         * previous one is not done. */
-        seq = seq_read(connectivity_seq_get());
-        if (seq != connectivity_seqno || status_txn_try_again) {
-            struct bridge *br;
 #ifdef OPS
-            struct vrf *vrf;
-#endif
-            connectivity_seqno = seq;
-            status_txn = ovsdb_idl_txn_create(idl);
-            HMAP_FOR_EACH (br, node, &all_bridges) {
-                struct port *port;
-
-#ifndef OPS_TEMP
-                br_refresh_stp_status(br);
-                br_refresh_rstp_status(br);
+static struct txn_writer status_writer =
+    TXN_WRITER_INITIALIZER("bridge-status", status_write, status_done, NULL);
 #endif
-                br_refresh_datapath_info(br);
-                HMAP_FOR_EACH (port, hmap_node, &br->ports) {
-                    struct iface *iface;
-
-#ifndef OPS_TEMP
-                    port_refresh_stp_status(port);
-                    port_refresh_rstp_status(port);
-                    port_refresh_bond_status(port, status_txn_try_again);
-#endif
-                    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        iface_refresh_netdev_status(iface);
-                        iface_refresh_ofproto_status(iface);
-                    }
-                }
-            }
 
+/* Update bridge/port/interface status if necessary. */
+static void
+run_status_update(void)
+{
 #ifdef OPS
-            HMAP_FOR_EACH (vrf, node, &all_vrfs) {
-                struct port *port;
-
-                HMAP_FOR_EACH (port, hmap_node, &vrf->up->ports) {
-                    struct iface *iface;
-
-                    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-                        iface_refresh_netdev_status(iface);
-                        iface_refresh_ofproto_status(iface);
-                    }
-                }
-            }
- #endif
-        }
+    /* Rate limit the update.  Do not start a new update if the previous one
+     * is not done. */
+    if (!txn_writer_is_busy(&status_writer) && status_update_needed()) {
+        txn_writer_request(&status_writer);
+    }
+#else
+    /* Rate limit the update.  Do not start a new update if the previous one
+     * is not done. */
+    if (!status_txn && status_update_needed()) {
+        status_txn = ovsdb_idl_txn_create(idl);
+        status_write(status_txn, NULL);
     }
 
     /* Commit the transaction and get the status. If the transaction finishes,
@@ -4083,40 +5944,35 @@ run_status_update(void)
         if (status != TXN_INCOMPLETE) {
             ovsdb_idl_txn_destroy(status_txn);
             status_txn = NULL;
-
-            /* Sets the 'status_txn_try_again' if the transaction fails. */
-            if (status == TXN_SUCCESS || status == TXN_UNCHANGED) {
-                status_txn_try_again = false;
-            } else {
-                status_txn_try_again = true;
-            }
+            status_done(status, NULL);
         }
     }
+#endif
 }
 
 #ifdef OPS
 struct bridge *
 get_bridge_from_port_name (char *port_name, struct port **port)
 {
-    struct bridge *br = NULL;
+    struct port *p;
 
     if (!port_name || !port) {
         VLOG_ERR("%s: invalid arguments", __FUNCTION__);
         return NULL;
     }
 
-    HMAP_FOR_EACH (br, node, &all_bridges) {
-        *port = port_lookup(br, port_name);
-        if (*port) {
-            break;
+    /* A VRF port may share its name with a bridge port while it moves from
+     * one to the other, and only bridge ports are looked for here. */
+    HMAP_FOR_EACH_WITH_HASH (p, global_node, hash_string(port_name, 0),
+                             &all_ports_by_name) {
+        if (!strcmp(p->name, port_name) && !p->bridge->vrf) {
+            *port = p;
+            return p->bridge;
         }
     }
 
-    if (*port) {
-        return br;
-    } else {
-        return NULL;
-    }
+    *port = NULL;
+    return NULL;
 }
 #endif
 
@@ -4130,13 +5986,22 @@ status_update_wait(void)
     }
 
     /* If the 'status_txn' is non-null (transaction incomplete), waits for the
-     * transaction to complete.  If the status update to database needs to be
-     * run again (transaction fails), registers a timeout in
+     * transaction to complete.  With OPS, txn_coalescer_wait() does it for
+     * 'status_writer'.  If the status update to database needs to be run
+     * again (transaction fails), registers a timeout in
      * 'STATUS_CHECK_AGAIN_MSEC'.  Otherwise, waits on the global connectivity
      * sequence number. */
+#ifdef OPS
+    if (txn_writer_is_busy(&status_writer)) {
+        return;
+    }
+#else
     if (status_txn) {
         ovsdb_idl_txn_wait(status_txn);
-    } else if (status_txn_try_again) {
+        return;
+    }
+#endif
+    if (status_txn_try_again) {
         poll_timer_wait_until(time_msec() + STATUS_CHECK_AGAIN_MSEC);
     } else {
         seq_wait(connectivity_seq_get(), connectivity_seqno);
@@ -4210,6 +6075,12 @@ bridge_run(void)
          * with the current situation of multiple ovs-vswitchd daemons,
          * disable system stats collection. */
         system_stats_enable(false);
+#ifdef OPS
+        /* The bridges are rebuilt from scratch once the lock is back. */
+        reconfigure_full = true;
+        reconfigure_blocks_force_all();
+        cold_start = true;
+#endif
         return;
     } else if (!ovsdb_idl_has_lock(idl)) {
         return;
@@ -4271,7 +6142,18 @@ bridge_run(void)
 #endif
         txn = ovsdb_idl_txn_create(idl);
 
+#ifdef OPS
+        if (!initial_config_done) {
+            size_t phase = startup_timeline_begin("first bridge_reconfigure");
+
+            bridge_reconfigure(cfg ? cfg : &null_cfg);
+            startup_timeline_end(phase);
+        } else {
+            bridge_reconfigure(cfg ? cfg : &null_cfg);
+        }
+#else
         bridge_reconfigure(cfg ? cfg : &null_cfg);
+#endif
 
 #ifdef OPS
         /* Update seqno after bridge_reconfigure, to access earlier
@@ -4311,20 +6193,39 @@ bridge_run(void)
             vlog_enable_async();
 
             VLOG_INFO_ONCE("%s (Open vSwitch) %s", program_name, VERSION);
+#ifdef OPS
+            startup_timeline_mark("daemonize complete");
+            bridge_startup_timeline_check();
+#endif
         }
     }
 
+#ifdef OPS
+    bridge_cold_start_run();
+#endif
     run_stats_update();
     run_status_update();
     run_system_stats();
 #ifdef OPS
     run_neighbor_update();
+    run_sflow_update();
 #endif
     run_params.idl = idl;
     run_params.idl_seqno = idl_seqno;
     execute_run_block(&run_params, BLK_RUN_COMPLETE);
 }
 
+#ifdef OPS
+/* Clears the change tracking of the IDL.  Called once per main loop
+ * iteration, after every module and plugin that follows the tracked rows of
+ * its tables ran, so that none of them clears the rows of the others. */
+void
+bridge_idl_track_clear(void)
+{
+    ovsdb_idl_track_clear(idl);
+}
+#endif
+
 void
 bridge_wait(void)
 {
@@ -4356,6 +6257,10 @@ bridge_wait(void)
 
     status_update_wait();
     system_stats_wait();
+#ifdef OPS
+    bridge_cold_start_wait();
+    sflow_governor_wait();
+#endif
 
     run_params.idl = idl;
     run_params.idl_seqno = idl_seqno;
@@ -4507,6 +6412,8 @@ bridge_create(const struct ovsrec_bridge *br_cfg)
     hmap_init(&br->iface_by_name);
 #ifdef OPS
     hmap_init(&br->vlans);
+    br->vlans_present = bitmap_allocate(4096);
+    br->vlans_enabled = bitmap_allocate(4096);
 #endif
     hmap_init(&br->mirrors);
     hmap_insert(&all_bridges, &br->node, hash_string(br->name, 0));
@@ -4527,6 +6434,7 @@ vrf_create(const struct ovsrec_vrf *vrf_cfg)
     ovs_assert(vrf->up->name);
     vrf->up->type = xstrdup("vrf");
     ovs_assert(vrf->up->type);
+    vrf->up->vrf = vrf;
     vrf->cfg = vrf_cfg;
 
     /* Use system mac as default mac */
@@ -4563,8 +6471,13 @@ bridge_destroy(struct bridge *br)
         hmap_destroy(&br->iface_by_name);
 #ifdef OPS
         hmap_destroy(&br->vlans);
+        bitmap_free(br->vlans_present);
+        bitmap_free(br->vlans_enabled);
 #endif
         hmap_destroy(&br->mirrors);
+#ifdef OPS
+        bridge_forget_sflow(br);
+#endif
         free(br->name);
         free(br->type);
         free(br);
@@ -4594,6 +6507,7 @@ vrf_destroy(struct vrf *vrf)
         hmap_destroy(&vrf->all_neighbors);
         hmap_destroy(&vrf->all_routes);
         hmap_destroy(&vrf->all_nexthops);
+        bridge_forget_sflow(vrf->up);
         free(vrf->up->name);
         free(vrf->up);
         free(vrf);
@@ -5215,8 +7129,7 @@ vlan_lookup_by_name(const struct bridge *br, const char *name)
 {
     struct vlan *vlan;
 
-    HMAP_FOR_EACH_WITH_HASH (vlan, hmap_node, hash_string(name, 0),
-                             &br->vlans) {
+    HMAP_FOR_EACH (vlan, hmap_node, &br->vlans) {
         if (!strcmp(vlan->name, name)) {
             return vlan;
         }
@@ -5229,7 +7142,7 @@ vlan_lookup_by_vid(const struct bridge *br, int vid)
 {
     struct vlan *vlan;
 
-    HMAP_FOR_EACH (vlan, hmap_node, &br->vlans) {
+    HMAP_FOR_EACH_WITH_HASH (vlan, hmap_node, hash_int(vid, 0), &br->vlans) {
         if (vlan->vid == vid) {
             return vlan;
         }
@@ -5286,7 +7199,7 @@ vlan_unixctl_show(struct unixctl_conn *conn, int argc,
     ds_destroy(&ds);
 }
 
-static void
+static struct vlan *
 vlan_create(struct bridge *br, const struct ovsrec_vlan *vlan_cfg)
 {
     struct vlan *new_vlan = NULL;
@@ -5297,16 +7210,18 @@ vlan_create(struct bridge *br, const struct ovsrec_vlan *vlan_cfg)
     /* Allocate structure to save state information for this VLAN. */
     new_vlan = xzalloc(sizeof(struct vlan));
 
-    hmap_insert(&br->vlans, &new_vlan->hmap_node,
-                hash_string(vlan_cfg->name, 0));
-
     new_vlan->bridge = br;
     new_vlan->cfg = vlan_cfg;
     new_vlan->vid = (int)vlan_cfg->id;
     new_vlan->name = xstrdup(vlan_cfg->name);
 
+    hmap_insert(&br->vlans, &new_vlan->hmap_node, hash_int(new_vlan->vid, 0));
+    bitmap_set1(br->vlans_present, new_vlan->vid);
+
     /* Initialize state to disabled.  Will handle this later. */
     new_vlan->enable = false;
+
+    return new_vlan;
 }
 
 static void
@@ -5315,6 +7230,7 @@ vlan_destroy(struct vlan *vlan)
     if (vlan) {
         struct bridge *br = vlan->bridge;
         hmap_remove(&br->vlans, &vlan->hmap_node);
+        bitmap_set0(br->vlans_present, vlan->vid);
         free(vlan->name);
         free(vlan);
     }
@@ -5335,84 +7251,164 @@ is_vlan_up(const char *vid)
    return false;
 }
 
+/* Returns the asic plugin if it can program VLANs in bulk, NULL otherwise. */
+static struct asic_plugin_interface *
+vlan_get_bulk_plugin(void)
+{
+    static struct asic_plugin_interface *asic_intf = NULL;
+    static bool looked_up = false;
+    struct plugin_extension_interface *extension = NULL;
+
+    if (!looked_up) {
+        looked_up = true;
+        if (!find_plugin_extension(ASIC_PLUGIN_INTERFACE_NAME,
+                                   ASIC_PLUGIN_INTERFACE_MAJOR, 0,
+                                   &extension)
+            && extension
+            && extension->minor >= ASIC_PLUGIN_SET_VLANS_MINOR) {
+            asic_intf = extension->plugin_interface;
+            if (!asic_intf->set_vlans) {
+                asic_intf = NULL;
+            }
+        }
+        VLOG_INFO("VLANs are programmed %s",
+                  asic_intf ? "in bulk" : "one at a time");
+    }
+    return asic_intf;
+}
+
+/* Disables the VLANs set in 'del' and enables the ones set in 'add' on the
+ * ofproto of 'br'.  Uses a single call to the asic plugin when it supports
+ * it, and falls back to one ofproto_set_vlan() call per VID otherwise. */
 static void
-bridge_configure_vlans(struct bridge *br)
+vlan_program(struct bridge *br, const unsigned long *add,
+             const unsigned long *del)
 {
-    size_t i;
-    struct vlan *vlan, *next;
-    struct shash sh_idl_vlans;
-    struct shash_node *sh_node;
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    struct asic_plugin_interface *asic_intf = vlan_get_bulk_plugin();
+    int vid;
 
-    /* Collect all the VLANs present in the DB. */
-    shash_init(&sh_idl_vlans);
-    for (i = 0; i < br->cfg->n_vlans; i++) {
-        const char *name = br->cfg->vlans[i]->name;
-        if (!shash_add_once(&sh_idl_vlans, name, br->cfg->vlans[i])) {
-            VLOG_WARN("bridge %s: %s specified twice as bridge VLAN",
-                      br->name, name);
+    if (asic_intf) {
+        int error = asic_intf->set_vlans(br->ofproto, add, del);
+
+        if (!error) {
+            COVERAGE_INC(bridge_vlan_bulk_update);
+            return;
         }
+        VLOG_WARN_RL(&rl, "bridge %s: bulk VLAN update failed (%s), "
+                     "setting VLANs one at a time", br->name,
+                     ovs_strerror(error));
+    }
+
+    for (vid = bitmap_scan(del, 1, 0, 4096); vid < 4096;
+         vid = bitmap_scan(del, 1, vid + 1, 4096)) {
+        ofproto_set_vlan(br->ofproto, vid, false);
+    }
+    for (vid = bitmap_scan(add, 1, 0, 4096); vid < 4096;
+         vid = bitmap_scan(add, 1, vid + 1, 4096)) {
+        ofproto_set_vlan(br->ofproto, vid, true);
     }
+}
+
+static bool
+vlan_cfg_is_enabled(const struct ovsrec_vlan *row)
+{
+    const char *hw_cfg_enable;
 
-    /* Delete old VLANs. */
-    HMAP_FOR_EACH_SAFE (vlan, next, hmap_node, &br->vlans) {
-        const struct ovsrec_vlan *vlan_cfg;
+    hw_cfg_enable = smap_get(&row->hw_vlan_config, VLAN_HW_CONFIG_MAP_ENABLE);
+    return hw_cfg_enable && !strcmp(hw_cfg_enable,
+                                    VLAN_HW_CONFIG_MAP_ENABLE_TRUE);
+}
 
-        vlan_cfg = shash_find_data(&sh_idl_vlans, vlan->name);
-        if (!vlan_cfg) {
-            VLOG_DBG("Found a deleted VLAN %s", vlan->name);
-            /* Need to update ofproto now since this VLAN
-             * won't be around for the "check for changes"
-             * loop below. */
-            ofproto_set_vlan(br->ofproto, vlan->vid, 0);
-            vlan_destroy(vlan);
-        }
-        else {
-            vlan->cfg = vlan_cfg;
+/* Tracks the VLANs of 'br' as bitmaps of VIDs: the VIDs wanted by the DB and
+ * the VIDs that should be enabled are compared word by word against the ones
+ * present and enabled from the previous run, and only the difference is
+ * pushed to ofproto. */
+static void
+bridge_configure_vlans(struct bridge *br)
+{
+    unsigned long wanted[BITMAP_N_LONGS(4096)];
+    unsigned long enabled[BITMAP_N_LONGS(4096)];
+    unsigned long gone[BITMAP_N_LONGS(4096)];
+    unsigned long add[BITMAP_N_LONGS(4096)];
+    unsigned long del[BITMAP_N_LONGS(4096)];
+    unsigned long changed = 0;
+    struct vlan *vlan;
+    size_t i;
+    int vid;
+
+    memset(wanted, 0, sizeof wanted);
+    memcpy(enabled, br->vlans_enabled, sizeof enabled);
+
+    /* Collect the VLANs present in the DB, creating the new ones and reading
+     * hw_vlan_config:enable of the rows that were inserted or modified. */
+    for (i = 0; i < br->cfg->n_vlans; i++) {
+        const struct ovsrec_vlan *row = br->cfg->vlans[i];
+
+        vid = row->id;
+        if (vid <= 0 || vid >= 4095) {
+            VLOG_WARN("bridge %s: VLAN %s has invalid VID %d",
+                      br->name, row->name, vid);
+            continue;
+        } else if (bitmap_is_set(wanted, vid)) {
+            VLOG_WARN("bridge %s: VLAN %d specified twice as bridge VLAN",
+                      br->name, vid);
+            continue;
         }
-    }
+        bitmap_set1(wanted, vid);
 
-    /* Add new VLANs. */
-    SHASH_FOR_EACH (sh_node, &sh_idl_vlans) {
-        vlan = vlan_lookup_by_name(br, sh_node->name);
+        vlan = (bitmap_is_set(br->vlans_present, vid)
+                ? vlan_lookup_by_vid(br, vid) : NULL);
         if (!vlan) {
-            VLOG_DBG("Found an added VLAN %s", sh_node->name);
-            vlan_create(br, sh_node->data);
+            VLOG_DBG("Found an added VLAN %s", row->name);
+            vlan = vlan_create(br, row);
+        }
+        vlan->cfg = row;
+
+        if (OVSREC_IDL_IS_ROW_INSERTED(row, idl_seqno) ||
+            OVSREC_IDL_IS_ROW_MODIFIED(row, idl_seqno)) {
+            if (strcmp(vlan->name, row->name)) {
+                free(vlan->name);
+                vlan->name = xstrdup(row->name);
+            }
+            bitmap_set(enabled, vid, vlan_cfg_is_enabled(row));
         }
     }
 
-    /* Check for changes in the VLAN row entries. */
-    HMAP_FOR_EACH (vlan, hmap_node, &br->vlans) {
-        const struct ovsrec_vlan *row = vlan->cfg;
-        if (row != NULL) {
-            /* Check for changes to row. */
-            if (OVSREC_IDL_IS_ROW_INSERTED(row, idl_seqno) ||
-                OVSREC_IDL_IS_ROW_MODIFIED(row, idl_seqno)) {
-                bool new_enable = false;
-                const char *hw_cfg_enable;
-
-                // Check for hw_vlan_config:enable string changes.
-                hw_cfg_enable = smap_get(&row->hw_vlan_config, VLAN_HW_CONFIG_MAP_ENABLE);
-                if (hw_cfg_enable) {
-                    if (!strcmp(hw_cfg_enable, VLAN_HW_CONFIG_MAP_ENABLE_TRUE)) {
-                        new_enable = true;
-                    }
-                }
+    /* Deleted VLANs are always disabled in ofproto, since they won't be
+     * around on the next run. */
+    for (i = 0; i < ARRAY_SIZE(wanted); i++) {
+        gone[i] = br->vlans_present[i] & ~wanted[i];
+        enabled[i] &= wanted[i];
+        del[i] = gone[i] | (br->vlans_enabled[i] & ~enabled[i]);
+        add[i] = enabled[i] & ~br->vlans_enabled[i];
+        changed |= add[i] | del[i];
+    }
+    if (!changed) {
+        return;
+    }
 
-                if (new_enable != vlan->enable) {
-                    VLOG_DBG("  VLAN %d changed, enable=%d, new_enable=%d.  "
-                             "idl_seq=%d, insert=%d, mod=%d",
-                             vlan->vid, vlan->enable, new_enable, idl_seqno,
-                             row->header_.insert_seqno,
-                             row->header_.modify_seqno);
+    for (vid = bitmap_scan(gone, 1, 0, 4096); vid < 4096;
+         vid = bitmap_scan(gone, 1, vid + 1, 4096)) {
+        vlan = vlan_lookup_by_vid(br, vid);
+        VLOG_DBG("Found a deleted VLAN %s", vlan->name);
+        vlan_destroy(vlan);
+    }
+    for (i = 0; i < ARRAY_SIZE(wanted); i++) {
+        unsigned long flipped = (add[i] | del[i]) & ~gone[i];
 
-                    vlan->enable = new_enable;
-                    ofproto_set_vlan(br->ofproto, vlan->vid, vlan->enable);
-                }
-            }
+        for (; flipped; flipped = zero_rightmost_1bit(flipped)) {
+            vid = i * BITMAP_ULONG_BITS + rightmost_1bit_idx(flipped);
+            vlan = vlan_lookup_by_vid(br, vid);
+            VLOG_DBG("  VLAN %d changed, enable=%d, new_enable=%d.  "
+                     "idl_seq=%d", vid, vlan->enable, !vlan->enable,
+                     idl_seqno);
+            vlan->enable = !vlan->enable;
         }
     }
-    /* Destroy the shash of the IDL vlans */
-    shash_destroy(&sh_idl_vlans);
+
+    vlan_program(br, add, del);
+    memcpy(br->vlans_enabled, enabled, sizeof enabled);
 }
 #endif
 
@@ -5434,6 +7430,10 @@ port_create(struct bridge *br, const struct ovsrec_port *cfg)
     list_init(&port->ifaces);
 
     hmap_insert(&br->ports, &port->hmap_node, hash_string(port->name, 0));
+#ifdef OPS
+    hmap_insert(&all_ports_by_name, &port->global_node,
+                hash_string(port->name, 0));
+#endif
     return port;
 }
 
@@ -5481,6 +7481,10 @@ port_destroy(struct port *port)
         }
 
         hmap_remove(&br->ports, &port->hmap_node);
+#ifdef OPS
+        hmap_remove(&all_ports_by_name, &port->global_node);
+        free(port->bundle_key);
+#endif
         free(port->name);
         free(port);
     }
@@ -5597,11 +7601,12 @@ iface_configure_lacp(struct iface *iface, struct lacp_slave_settings *s)
 }
 #endif
 
-static void
+/* Fills in 's' from the bond configuration of 'port' and returns the miimon
+ * interval of its interfaces, 0 to use carrier detection. */
+static int
 port_configure_bond(struct port *port, struct bond_settings *s)
 {
     const char *detect_s;
-    struct iface *iface;
     const char *mac_s;
     int miimon_interval;
 #ifdef OPS
@@ -5685,16 +7690,13 @@ port_configure_bond(struct port *port, struct bond_settings *s)
     s->lacp_fallback_ab_cfg = smap_get_bool(&port->cfg->other_config,
                                        "lacp-fallback-ab", false);
 
-    LIST_FOR_EACH (iface, port_elem, &port->ifaces) {
-        netdev_set_miimon_interval(iface->netdev, miimon_interval);
-    }
-
     mac_s = port->cfg->bond_active_slave;
     if (!mac_s || !ovs_scan(mac_s, ETH_ADDR_SCAN_FMT,
                             ETH_ADDR_SCAN_ARGS(s->active_slave_mac))) {
         /* OVSDB did not store the last active interface */
         s->active_slave_mac = eth_addr_zero;
     }
+    return miimon_interval;
 }
 
 #ifndef OPS_TEMP
@@ -5753,11 +7755,23 @@ iface_destroy__(struct iface *iface)
 
         list_remove(&iface->port_elem);
         hmap_remove(&br->iface_by_name, &iface->name_node);
+#ifdef OPS
+        hmap_remove(&all_ifaces_by_name, &iface->global_node);
+        port_bundle_forget(port);
+#endif
+#ifdef OPS_TEMP
+        list_remove(&iface->status_elem);
+#endif
 
         /* The user is changing configuration here, so netdev_remove needs to be
          * used as opposed to netdev_close */
         netdev_remove(iface->netdev);
 
+#ifdef OPS
+        iface_rate_destroy(iface->rate);
+        iface_subintf_parent_changed(iface->name, false);
+        iface_subintf_forget(iface);
+#endif
         free(iface->name);
         free(iface);
     }
@@ -5795,6 +7809,16 @@ iface_lookup(const struct bridge *br, const char *name)
 static struct iface *
 iface_find(const char *name)
 {
+#ifdef OPS
+    struct iface *iface;
+
+    HMAP_FOR_EACH_WITH_HASH (iface, global_node, hash_string(name, 0),
+                             &all_ifaces_by_name) {
+        if (!strcmp(iface->name, name) && !iface->port->bridge->vrf) {
+            return iface;
+        }
+    }
+#else
     const struct bridge *br;
 
     HMAP_FOR_EACH (br, node, &all_bridges) {
@@ -5804,6 +7828,7 @@ iface_find(const char *name)
             return iface;
         }
     }
+#endif
     return NULL;
 }
 #endif
@@ -7206,16 +9231,68 @@ vrf_reconfigure_neighbors(struct vrf *vrf)
 } /* add_reconfigure_neighbors */
 
 /* Read/Reset neighbors data-path hit-bit and update into db */
+static void
+neighbor_write(struct ovsdb_idl_txn *txn OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    const struct ovsrec_neighbor *idl_neighbor;
+    struct neighbor *neighbor;
+    const struct vrf *vrf;
+    struct port *port;
+
+    OVSREC_NEIGHBOR_FOR_EACH(idl_neighbor, idl) {
+        VLOG_DBG(" Checking hit-bit for %s", idl_neighbor->ip_address);
+
+        vrf = vrf_lookup(idl_neighbor->vrf->name);
+        neighbor = neighbor_hash_lookup(vrf, idl_neighbor->ip_address);
+        if ( (neighbor == NULL) || (neighbor->l3_egress_id == -1) ) {
+            VLOG_DBG("Neighbor not found in local hash or egress-id=-1");
+            continue;
+        }
+
+        /* Get port/ofproto info */
+        port = port_lookup(neighbor->vrf->up, neighbor->port_name);
+        if (port == NULL) {
+            VLOG_ERR("Failed to get port cfg for %s", neighbor->port_name);
+            continue;
+        }
+
+        /* Call Provider */
+        if (!ofproto_get_l3_host_hit(neighbor->vrf->up->ofproto, port,
+                                    neighbor->is_ipv6_addr,
+                                    idl_neighbor->ip_address,
+                                    &neighbor->hit_bit)) {
+            VLOG_DBG("Got host %s hit bit=0x%x",
+                      idl_neighbor->ip_address, neighbor->hit_bit);
+
+            struct smap smap;
+
+            /* Write the hit bit status to status column */
+            smap_clone(&smap, &idl_neighbor->status);
+            if (neighbor->hit_bit) {
+                smap_replace(&smap, OVSDB_NEIGHBOR_STATUS_DP_HIT, "true");
+            } else {
+                smap_replace(&smap, OVSDB_NEIGHBOR_STATUS_DP_HIT, "false");
+            }
+            ovsrec_neighbor_set_status(idl_neighbor, &smap);
+            smap_destroy(&smap);
+        }
+        else {
+            VLOG_ERR("!ofproto_get_l3_host_hit failed");
+            continue;
+        }
+    } /* For each */
+}
+
+/* No need to retry since we will update with latest state every 10sec */
+static struct txn_writer neighbor_writer =
+    TXN_WRITER_INITIALIZER("neighbor-hit-bit", neighbor_write, NULL, NULL);
+
 static void
 run_neighbor_update(void)
 {
     const struct ovsrec_neighbor *idl_neighbor =
                                   ovsrec_neighbor_first(idl);
-    struct neighbor *neighbor;
     int neighbor_interval;
-    const struct vrf *vrf;
-    struct port *port;
-    struct ovsdb_idl_txn *txn;
 
     /* Skip if nothing to update */
     if (idl_neighbor ==  NULL) {
@@ -7237,58 +9314,9 @@ run_neighbor_update(void)
     }
 
     if (time_msec() >= neighbor_timer) {
-        //enum ovsdb_idl_txn_status status;
-
-        txn = ovsdb_idl_txn_create(idl);
-
-        /* Rate limit the update.  Do not start a new update if the
-        ** previous one is not done. */
-        OVSREC_NEIGHBOR_FOR_EACH(idl_neighbor, idl) {
-            VLOG_DBG(" Checking hit-bit for %s", idl_neighbor->ip_address);
-
-            vrf = vrf_lookup(idl_neighbor->vrf->name);
-            neighbor = neighbor_hash_lookup(vrf, idl_neighbor->ip_address);
-            if ( (neighbor == NULL) || (neighbor->l3_egress_id == -1) ) {
-                VLOG_DBG("Neighbor not found in local hash or egress-id=-1");
-                continue;
-            }
-
-            /* Get port/ofproto info */
-            port = port_lookup(neighbor->vrf->up, neighbor->port_name);
-            if (port == NULL) {
-                VLOG_ERR("Failed to get port cfg for %s", neighbor->port_name);
-                continue;
-            }
-
-            /* Call Provider */
-            if (!ofproto_get_l3_host_hit(neighbor->vrf->up->ofproto, port,
-                                        neighbor->is_ipv6_addr,
-                                        idl_neighbor->ip_address,
-                                        &neighbor->hit_bit)) {
-                VLOG_DBG("Got host %s hit bit=0x%x",
-                          idl_neighbor->ip_address, neighbor->hit_bit);
-
-                struct smap smap;
-
-                /* Write the hit bit status to status column */
-                smap_clone(&smap, &idl_neighbor->status);
-                if (neighbor->hit_bit) {
-                    smap_replace(&smap, OVSDB_NEIGHBOR_STATUS_DP_HIT, "true");
-                } else {
-                    smap_replace(&smap, OVSDB_NEIGHBOR_STATUS_DP_HIT, "false");
-                }
-                ovsrec_neighbor_set_status(idl_neighbor, &smap);
-                smap_destroy(&smap);
-            }
-            else {
-                VLOG_ERR("!ofproto_get_l3_host_hit failed");
-                continue;
-            }
-        } /* For each */
-
-        /* No need to retry since we will update with latest state every 10sec */
-        ovsdb_idl_txn_commit(txn);
-        ovsdb_idl_txn_destroy(txn);
+        /* The hit bits are read and written by the coalesced transaction at
+         * the end of this main loop iteration. */
+        txn_writer_request(&neighbor_writer);
 
         neighbor_timer = time_msec() + neighbor_timer_interval;
     }
@@ -42,6 +42,7 @@
 #include "seq.h"
 #include "smap.h"
 #include "timeval.h"
+#include "txn-coalescer.h"
 
 
 VLOG_DEFINE_THIS_MODULE(bufmon);
@@ -193,64 +194,64 @@ End:
 
 } /* bufmon_create_counters_list */
 
+/* Writes the counter values and status changes into the transaction
+ * coalesced at the end of the main loop iteration. */
 static void
-bufmon_ovsdb_update(void)
+bufmon_ovsdb_update(struct ovsdb_idl_txn *txn OVS_UNUSED, void *aux OVS_UNUSED)
+                    OVS_EXCLUDED(bufmon_mutex)
 {
     const struct ovsrec_bufmon *counter_row = NULL;
     const struct ovsrec_open_vswitch *system_cfg = NULL;
     int i = 0;
     char status[32] = {0};
-    enum ovsdb_idl_txn_status txn_status = TXN_ERROR;
     char time_stamp[256];
-    static struct ovsdb_idl_txn *bufmon_stats_txn = NULL;
 
-    /* Update the counter values and status changes to the dB. */
-    if (!bufmon_stats_txn) {
-
-        bufmon_stats_txn = ovsdb_idl_txn_create(idl);
-
-        system_cfg = ovsrec_open_vswitch_first(idl);
-
-        /* Update the timestamp */
-        if (system_cfg) {
-            sprintf(time_stamp, "%lld", (long long)time_now());
-            smap_replace((struct smap *)&system_cfg->bufmon_info,
-                         BUFMON_INFO_MAP_LAST_COLLECTION_TIMESTAMP,
-                         (const char *) time_stamp);
-            ovsrec_open_vswitch_set_bufmon_info(system_cfg ,
-                            (const struct smap *)&system_cfg->bufmon_info);
-        }
+    ovs_mutex_lock(&bufmon_mutex);
 
-        OVSREC_BUFMON_FOR_EACH (counter_row, idl) {
-            if (counter_row && counter_row->enabled) {
-                bufmon_counter_info_t *counter = &g_counter_list[i];
-                ovsrec_bufmon_set_counter_value(counter_row,
-                                                &counter->counter_value, 1);
+    system_cfg = ovsrec_open_vswitch_first(idl);
 
-                /* Update the counter status whether poll or trigger */
-                if (counter->status == BUFMON_STATUS_TRIGGERED) {
-                    strncpy(status, OVSREC_BUFMON_STATUS_TRIGGERED, sizeof(status));
-                } else {
-                    strncpy(status, OVSREC_BUFMON_STATUS_OK, sizeof(status));
-                }
+    /* Update the timestamp */
+    if (system_cfg) {
+        sprintf(time_stamp, "%lld", (long long)time_now());
+        smap_replace((struct smap *)&system_cfg->bufmon_info,
+                     BUFMON_INFO_MAP_LAST_COLLECTION_TIMESTAMP,
+                     (const char *) time_stamp);
+        ovsrec_open_vswitch_set_bufmon_info(system_cfg ,
+                        (const struct smap *)&system_cfg->bufmon_info);
+    }
 
-                ovsrec_bufmon_set_status(counter_row, status);
-                i++;
+    OVSREC_BUFMON_FOR_EACH (counter_row, idl) {
+        if (counter_row && counter_row->enabled) {
+            bufmon_counter_info_t *counter = &g_counter_list[i];
+            ovsrec_bufmon_set_counter_value(counter_row,
+                                            &counter->counter_value, 1);
+
+            /* Update the counter status whether poll or trigger */
+            if (counter->status == BUFMON_STATUS_TRIGGERED) {
+                strncpy(status, OVSREC_BUFMON_STATUS_TRIGGERED, sizeof(status));
+            } else {
+                strncpy(status, OVSREC_BUFMON_STATUS_OK, sizeof(status));
             }
+
+            ovsrec_bufmon_set_status(counter_row, status);
+            i++;
         }
     }
 
-    /* TODO Retry OVSDB update*/
-    if (bufmon_stats_txn) {
-        /* Some OVSDB write needs to happen.*/
-        txn_status = ovsdb_idl_txn_commit(bufmon_stats_txn);
-        ovsdb_idl_txn_destroy(bufmon_stats_txn);
-        bufmon_stats_txn = NULL;
-    }
+    ovs_mutex_unlock(&bufmon_mutex);
+} /* bufmon_ovsdb_update */
 
+/* TODO Retry OVSDB update*/
+static void
+bufmon_ovsdb_update_done(enum ovsdb_idl_txn_status txn_status,
+                         void *aux OVS_UNUSED)
+{
     VLOG_DBG("bufmon_ovsdb_update %d \n", txn_status);
+} /* bufmon_ovsdb_update_done */
 
-} /* bufmon_ovsdb_update */
+static struct txn_writer bufmon_writer =
+    TXN_WRITER_INITIALIZER("bufmon", bufmon_ovsdb_update,
+                           bufmon_ovsdb_update_done, NULL);
 
 static void
 bufmon_get_current_counters_value(bool triggered)
@@ -471,7 +472,7 @@ bufmon_run(void)
     ovs_mutex_lock(&bufmon_mutex);
 
     if (bufmon_cfg.enabled && latch_poll(&bufmon_latch)) {
-        bufmon_ovsdb_update();
+        txn_writer_request(&bufmon_writer);
     }
 
     ovs_mutex_unlock(&bufmon_mutex);
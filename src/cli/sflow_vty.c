@@ -67,42 +67,36 @@ sflow_insert(struct ovsdb_idl_txn *txn)
 }
 
 /*
- * This function is used to aggregate the total number of ingress and egress
- * samples on all interfaces.
+ * This function returns the value of 'key' in the statistics of the sFlow
+ * row, or 0 if it has none.
  */
 static uint64_t
-sflow_aggregate_sample_count(void)
+sflow_statistic_get(const struct ovsrec_sflow *sflow_row, const char *key)
 {
-    uint64_t total_sample_count = 0;
-    uint64_t packet_count = 0;
-    unsigned int index;
-
-    const struct ovsrec_interface *ifrow;
     const struct ovsdb_datum *datum;
     union ovsdb_atom atom;
+    unsigned int index;
 
-    OVSREC_INTERFACE_FOR_EACH (ifrow, idl)
-    {
-        datum = ovsrec_interface_get_statistics(ifrow, OVSDB_TYPE_STRING,
-                                                OVSDB_TYPE_INTEGER);
-        if (datum) {
-            /* Fetch the number of sFlow ingress packets */
-            atom.string = "sflow_ingress_packets";
-            index = ovsdb_datum_find_key(datum, &atom, OVSDB_TYPE_STRING);
-            packet_count =
-                    (index == UINT_MAX) ? 0 : datum->values[index].integer;
-            total_sample_count = total_sample_count + packet_count;
-
-            /* Fetch the number of sFlow egress packets */
-            atom.string = "sflow_egress_packets";
-            index = ovsdb_datum_find_key(datum, &atom, OVSDB_TYPE_STRING);
-            packet_count =
-                    (index == UINT_MAX) ? 0 : datum->values[index].integer;
-            total_sample_count = total_sample_count + packet_count;
-        }
+    datum = ovsrec_sflow_get_statistics(sflow_row, OVSDB_TYPE_STRING,
+                                        OVSDB_TYPE_INTEGER);
+    if (!datum) {
+        return 0;
     }
+    atom.string = (char *) key;
+    index = ovsdb_datum_find_key(datum, &atom, OVSDB_TYPE_STRING);
+    return (index == UINT_MAX) ? 0 : datum->values[index].integer;
+}
 
-    return total_sample_count;
+/*
+ * This function returns the total number of ingress and egress samples on
+ * all interfaces.  switchd keeps the totals in the sFlow row statistics, so
+ * that the Interface rows are not walked.
+ */
+static uint64_t
+sflow_aggregate_sample_count(const struct ovsrec_sflow *sflow_row)
+{
+    return sflow_statistic_get(sflow_row, "sflow_ingress_packets")
+           + sflow_statistic_get(sflow_row, "sflow_egress_packets");
 }
 
 /* This function displays the sflow configuration set in the sFlow table */
@@ -111,6 +105,7 @@ sflow_show(void)
 {
     const struct ovsrec_system *system_row;
     const struct ovsrec_sflow *sflow_row;
+    uint64_t effective_rate;
     size_t i = 0;
     char temp_ip[MAX_COLLECTOR_LENGTH];
     char *collector_ip, *collector_port, *collector_vrf;
@@ -227,6 +222,14 @@ sflow_show(void)
                 SFL_DEFAULT_SAMPLING_RATE, VTY_NEWLINE);
     }
 
+    /* Published by switchd.  Differs from the configured rate when the
+     * sampling governor adjusted it. */
+    effective_rate = sflow_statistic_get(sflow_row, "effective_sampling_rate");
+    if (effective_rate && system_row->sflow != NULL) {
+        vty_out(vty, "Effective Sampling Rate       %"PRIu64"%s",
+                effective_rate, VTY_NEWLINE);
+    }
+
     if (sflow_row->polling != NULL) {
         vty_out(vty, "Polling Interval              %"PRIu64"%s",
                 *(sflow_row->polling), VTY_NEWLINE);
@@ -252,7 +255,11 @@ sflow_show(void)
     }
 
     vty_out(vty, "Number of Samples             %"PRIu64"%s",
-            sflow_aggregate_sample_count(), VTY_NEWLINE);
+            sflow_aggregate_sample_count(sflow_row), VTY_NEWLINE);
+    vty_out(vty, "Samples per Second            %"PRIu64"%s",
+            sflow_statistic_get(sflow_row, "sflow_ingress_packets_per_sec")
+            + sflow_statistic_get(sflow_row, "sflow_egress_packets_per_sec"),
+            VTY_NEWLINE);
 
     return CMD_SUCCESS;
 }
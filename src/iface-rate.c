@@ -0,0 +1,189 @@
+/* Copyright (c) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include "iface-rate.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "netdev.h"
+#include "smap.h"
+#include "stats-blocks.h"
+#include "timeval.h"
+#include "util.h"
+#include "vswitch-idl.h"
+
+/* EWMA window, in milliseconds, used when neither the Open_vSwitch nor the
+ * Interface other_config column specifies "stats-rate-window". */
+#define IFACE_RATE_DFLT_WINDOW_MSEC 30000
+
+/* Smallest accepted EWMA window, in milliseconds. */
+#define IFACE_RATE_MIN_WINDOW_MSEC  1000
+
+struct iface_rate {
+    /* Previous sample. */
+    long long int last_msec;    /* Time of the previous sample, 0 if none. */
+    uint64_t rx_packets;
+    uint64_t tx_packets;
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+
+    struct iface_rates rates;   /* Smoothed rates. */
+};
+
+static int default_window_msec = IFACE_RATE_DFLT_WINDOW_MSEC;
+
+struct iface_rate *
+iface_rate_create(void)
+{
+    return xzalloc(sizeof(struct iface_rate));
+}
+
+void
+iface_rate_destroy(struct iface_rate *rate)
+{
+    free(rate);
+}
+
+/* Reads the system wide EWMA window from the Open_vSwitch 'other_config'. */
+void
+iface_rate_set_default_window(const struct smap *other_config)
+{
+    default_window_msec = MAX(smap_get_int(other_config, "stats-rate-window",
+                                           IFACE_RATE_DFLT_WINDOW_MSEC),
+                              IFACE_RATE_MIN_WINDOW_MSEC);
+}
+
+/* Folds 'sample', measured over 'elapsed' msec, into the smoothed value at
+ * '*avg' using a first order approximation of exp(-elapsed / window).  The
+ * first delta seeds the average directly. */
+static void
+iface_rate_ewma(double *avg, double sample, long long int elapsed,
+                int window, bool seeded)
+{
+    if (!seeded) {
+        *avg = sample;
+    } else {
+        double alpha = (double) elapsed / (elapsed + window);
+
+        *avg += alpha * (sample - *avg);
+    }
+}
+
+/* Returns the per second rate of a counter that went from 'prev' to 'cur'
+ * over 'elapsed' msec.  Unsupported counters and counter resets yield a
+ * negative value so that the caller keeps its previous average. */
+static double
+iface_rate_delta(uint64_t prev, uint64_t cur, long long int elapsed)
+{
+    if (prev == UINT64_MAX || cur == UINT64_MAX || cur < prev) {
+        return -1.0;
+    }
+    return (double) (cur - prev) * 1000.0 / elapsed;
+}
+
+/* Updates 'rate' from the newly collected 'stats' of the interface whose
+ * configuration is 'cfg'. */
+void
+iface_rate_update(struct iface_rate *rate, const struct netdev_stats *stats,
+                  const struct ovsrec_interface *cfg)
+{
+    struct iface_rates *r = &rate->rates;
+    long long int now = time_msec();
+    long long int elapsed = now - rate->last_msec;
+    int64_t link_speed = 0;
+    int window;
+
+    if (rate->last_msec && elapsed > 0) {
+        bool seeded = r->valid;
+        double rx_pps, tx_pps, rx_bps, tx_bps;
+
+        window = MAX(smap_get_int(&cfg->other_config, "stats-rate-window",
+                                  default_window_msec),
+                     IFACE_RATE_MIN_WINDOW_MSEC);
+
+        rx_pps = iface_rate_delta(rate->rx_packets, stats->rx_packets,
+                                  elapsed);
+        tx_pps = iface_rate_delta(rate->tx_packets, stats->tx_packets,
+                                  elapsed);
+        rx_bps = iface_rate_delta(rate->rx_bytes, stats->rx_bytes, elapsed);
+        tx_bps = iface_rate_delta(rate->tx_bytes, stats->tx_bytes, elapsed);
+
+        if (rx_pps >= 0) {
+            iface_rate_ewma(&r->rx_pps, rx_pps, elapsed, window, seeded);
+        }
+        if (tx_pps >= 0) {
+            iface_rate_ewma(&r->tx_pps, tx_pps, elapsed, window, seeded);
+        }
+        if (rx_bps >= 0) {
+            iface_rate_ewma(&r->rx_bps, rx_bps * 8, elapsed, window, seeded);
+        }
+        if (tx_bps >= 0) {
+            iface_rate_ewma(&r->tx_bps, tx_bps * 8, elapsed, window, seeded);
+        }
+
+        if (cfg->n_link_speed) {
+            link_speed = cfg->link_speed[0];
+        }
+        r->rx_util = link_speed > 0 ? r->rx_bps * 100.0 / link_speed : 0;
+        r->tx_util = link_speed > 0 ? r->tx_bps * 100.0 / link_speed : 0;
+        r->valid = true;
+    }
+
+    rate->last_msec = now;
+    rate->rx_packets = stats->rx_packets;
+    rate->tx_packets = stats->tx_packets;
+    rate->rx_bytes = stats->rx_bytes;
+    rate->tx_bytes = stats->tx_bytes;
+}
+
+const struct iface_rates *
+iface_rate_get(const struct iface_rate *rate)
+{
+    return &rate->rates;
+}
+
+/* Appends the smoothed rates of 'rate' to 'keys' and 'values', which must
+ * have room for IFACE_RATE_N_KEYS more elements.  Utilization is published
+ * in hundredths of a percent.  Returns the number of elements appended. */
+size_t
+iface_rate_put_stats(const struct iface_rate *rate,
+                     char **keys, int64_t *values)
+{
+    const struct iface_rates *r = &rate->rates;
+    size_t n = 0;
+
+    if (!r->valid) {
+        return 0;
+    }
+
+#define IFACE_RATE(NAME, VALUE)                 \
+    keys[n] = NAME;                             \
+    values[n] = (VALUE);                        \
+    n++;
+    IFACE_RATE("rx_pps",  r->rx_pps);
+    IFACE_RATE("tx_pps",  r->tx_pps);
+    IFACE_RATE("rx_bps",  r->rx_bps);
+    IFACE_RATE("tx_bps",  r->tx_bps);
+    IFACE_RATE("rx_util", r->rx_util * 100);
+    IFACE_RATE("tx_util", r->tx_util * 100);
+#undef IFACE_RATE
+    ovs_assert(n <= IFACE_RATE_N_KEYS);
+
+    return n;
+}
@@ -0,0 +1,54 @@
+/* Copyright (c) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VSWITCHD_IFACE_RATE_H
+#define VSWITCHD_IFACE_RATE_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Interface rate computation.
+ *
+ * Each time interface statistics are collected, the new counters are
+ * compared against the previous sample of the same interface and the
+ * resulting rx/tx packet, bit and utilization rates are smoothed with an
+ * exponentially weighted moving average.  The EWMA window defaults to
+ * "stats-rate-window" in the Open_vSwitch other_config column and may be
+ * overridden per interface through the Interface other_config column.
+ *
+ * The smoothed rates are published in the Interface statistics column next
+ * to the raw counters (see IFACE_RATE_N_KEYS) and handed to the stats
+ * blocks through 'struct stats_blk_params'. */
+
+struct iface_rate;
+struct iface_rates;
+struct netdev_stats;
+struct ovsrec_interface;
+struct smap;
+
+/* Number of keys iface_rate_put_stats() may append. */
+#define IFACE_RATE_N_KEYS 6
+
+struct iface_rate *iface_rate_create(void);
+void iface_rate_destroy(struct iface_rate *);
+
+void iface_rate_set_default_window(const struct smap *other_config);
+void iface_rate_update(struct iface_rate *, const struct netdev_stats *,
+                       const struct ovsrec_interface *);
+const struct iface_rates *iface_rate_get(const struct iface_rate *);
+size_t iface_rate_put_stats(const struct iface_rate *,
+                            char **keys, int64_t *values);
+
+#endif /* iface-rate.h */
@@ -54,6 +54,8 @@
 #ifdef OPS
 #include "subsystem.h"
 #include "bufmon-provider.h"
+#include "txn-coalescer.h"
+#include "startup-timeline.h"
 #endif
 
 VLOG_DEFINE_THIS_MODULE(vswitchd);
@@ -77,8 +79,14 @@ main(int argc, char *argv[])
     char *remote;
     bool exiting;
     int retval;
+#ifdef OPS
+    size_t phase;
+#endif
 
     set_program_name(argv[0]);
+#ifdef OPS
+    startup_timeline_init();
+#endif
     retval = dpdk_init(argc,argv);
     argc -= retval;
     argv += retval;
@@ -113,18 +121,34 @@ main(int argc, char *argv[])
      * all plugins, the calls their init() functions.  These init() functions
      * may, in turn, want to register for BLK_BR_INIT callback.
     */
+#ifdef OPS
+    phase = startup_timeline_begin("plugins_init");
+#endif
     plugins_init(plugins_path);
-    bridge_init(remote);
+#ifdef OPS
+    startup_timeline_end(phase);
 
+    phase = startup_timeline_begin("bridge_init");
+#endif
+    bridge_init(remote);
 #ifdef OPS
+    startup_timeline_end(phase);
+
+    phase = startup_timeline_begin("plugins_netdev_register");
     plugins_netdev_register();
+    startup_timeline_end(phase);
 
+    phase = startup_timeline_begin("subsystem_init");
     subsystem_init();
+    startup_timeline_end(phase);
 
+    phase = startup_timeline_begin("bufmon_init");
     bufmon_init();
+    startup_timeline_end(phase);
 
+    phase = startup_timeline_begin("wait_for_config_complete");
     wait_for_config_complete();
-
+    startup_timeline_end(phase);
 #endif
 
     free(remote);
@@ -140,6 +164,9 @@ main(int argc, char *argv[])
             memory_report(&usage);
             simap_destroy(&usage);
         }
+#ifdef OPS
+        subsystem_link_run();
+#endif
         bridge_run();
 #ifdef OPS
         subsystem_run();
@@ -148,6 +175,11 @@ main(int argc, char *argv[])
         unixctl_server_run(unixctl);
         netdev_run();
         plugins_run();
+#ifdef OPS
+        /* Commits the database writes requested by the modules above. */
+        txn_coalescer_run();
+        bridge_idl_track_clear();
+#endif
 
         memory_wait();
         bridge_wait();
@@ -158,6 +190,9 @@ main(int argc, char *argv[])
         unixctl_server_wait(unixctl);
         netdev_wait();
         plugins_wait();
+#ifdef OPS
+        txn_coalescer_wait();
+#endif
         if (exiting) {
             poll_immediate_wake();
         }
@@ -0,0 +1,226 @@
+/* Copyright (c) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include "sflow-governor.h"
+
+#include <inttypes.h>
+#include <limits.h>
+#include <string.h>
+
+#include "copp-asic-provider.h"
+#include "plugin-extensions.h"
+#include "poll-loop.h"
+#include "smap.h"
+#include "timeval.h"
+#include "util.h"
+#include "openvswitch/vlog.h"
+
+VLOG_DEFINE_THIS_MODULE(sflow_governor);
+
+/* Default CPU usage thresholds of SwitchD, in percent. */
+#define SFLOW_GOVERNOR_DFLT_CPU_HIGH 80
+#define SFLOW_GOVERNOR_DFLT_CPU_LOW  40
+
+/* The COPP statistics are read from the first ASIC. */
+#define SFLOW_GOVERNOR_HW_ASIC_ID 0
+
+struct sflow_governor_settings {
+    bool enabled;
+    int cpu_high;
+    int cpu_low;
+    uint32_t min_rate;          /* 0 for the configured rate. */
+    uint32_t max_rate;          /* 0 for a multiple of the configured rate. */
+};
+
+static struct sflow_governor_settings settings;
+
+static uint32_t configured_rate;    /* 0 until sFlow is applied. */
+static uint32_t effective_rate;
+static unsigned int n_calm;         /* Calm intervals in a row. */
+static long long int next_run = LLONG_MIN;
+
+static uint64_t last_drops;
+static bool last_drops_valid;
+
+void
+sflow_governor_configure(const struct smap *other_config)
+{
+    struct sflow_governor_settings new;
+
+    memset(&new, 0, sizeof new);
+    new.enabled = smap_get_bool(other_config, "sflow-governor", false);
+    new.cpu_high = smap_get_int(other_config, "sflow-governor-cpu-high",
+                                SFLOW_GOVERNOR_DFLT_CPU_HIGH);
+    new.cpu_low = MIN(smap_get_int(other_config, "sflow-governor-cpu-low",
+                                   SFLOW_GOVERNOR_DFLT_CPU_LOW),
+                      new.cpu_high);
+    new.min_rate = MAX(smap_get_int(other_config,
+                                    "sflow-governor-min-sampling", 0), 0);
+    new.max_rate = MAX(smap_get_int(other_config,
+                                    "sflow-governor-max-sampling", 0), 0);
+
+    if (memcmp(&new, &settings, sizeof new)) {
+        memcpy(&settings, &new, sizeof settings);
+
+        /* Start over from the configured rate the next time it is asked. */
+        configured_rate = 0;
+        n_calm = 0;
+        last_drops_valid = false;
+        next_run = LLONG_MIN;
+    }
+}
+
+static uint32_t
+sflow_governor_min_rate(void)
+{
+    return settings.min_rate ? settings.min_rate : configured_rate;
+}
+
+static uint32_t
+sflow_governor_max_rate(void)
+{
+    uint64_t max = settings.max_rate
+                   ? settings.max_rate
+                   : (uint64_t) configured_rate
+                     * SFLOW_GOVERNOR_DFLT_MAX_FACTOR;
+
+    return MAX(MIN(max, UINT32_MAX), sflow_governor_min_rate());
+}
+
+static uint32_t
+sflow_governor_clamp(uint64_t rate)
+{
+    return MIN(MAX(rate, sflow_governor_min_rate()),
+               sflow_governor_max_rate());
+}
+
+uint32_t
+sflow_governor_rate(uint32_t configured)
+{
+    if (!settings.enabled || !configured) {
+        configured_rate = 0;
+        return configured;
+    }
+
+    if (configured != configured_rate) {
+        configured_rate = configured;
+        effective_rate = sflow_governor_clamp(configured);
+        n_calm = 0;
+    }
+    return effective_rate;
+}
+
+/* Returns the asic plugin if it reports COPP statistics, NULL otherwise. */
+static struct copp_asic_plugin_interface *
+sflow_governor_get_copp_plugin(void)
+{
+    static struct copp_asic_plugin_interface *copp_intf = NULL;
+    static bool looked_up = false;
+    struct plugin_extension_interface *extension = NULL;
+
+    if (!looked_up) {
+        looked_up = true;
+        if (!find_plugin_extension(COPP_ASIC_PLUGIN_INTERFACE_NAME,
+                                   COPP_ASIC_PLUGIN_INTERFACE_MAJOR,
+                                   COPP_ASIC_PLUGIN_INTERFACE_MINOR,
+                                   &extension)
+            && extension) {
+            copp_intf = extension->plugin_interface;
+            if (!copp_intf->copp_stats_get) {
+                copp_intf = NULL;
+            }
+        }
+        if (!copp_intf) {
+            VLOG_INFO("no COPP statistics, sFlow sampling follows the CPU "
+                      "usage only");
+        }
+    }
+    return copp_intf;
+}
+
+/* Returns the number of sFlow samples the COPP class dropped since the
+ * previous call. */
+static uint64_t
+sflow_governor_copp_drops(void)
+{
+    struct copp_asic_plugin_interface *copp_intf;
+    struct copp_protocol_stats stats;
+    uint64_t drops;
+
+    copp_intf = sflow_governor_get_copp_plugin();
+    if (!copp_intf) {
+        return 0;
+    }
+
+    memset(&stats, 0, sizeof stats);
+    if (copp_intf->copp_stats_get(SFLOW_GOVERNOR_HW_ASIC_ID,
+                                  COPP_sFLOW_SAMPLES, &stats)) {
+        last_drops_valid = false;
+        return 0;
+    }
+
+    drops = (last_drops_valid && stats.packets_dropped >= last_drops
+             ? stats.packets_dropped - last_drops
+             : 0);
+    last_drops = stats.packets_dropped;
+    last_drops_valid = true;
+    return drops;
+}
+
+bool
+sflow_governor_run(void)
+{
+    uint32_t old_rate = effective_rate;
+    uint64_t drops;
+    int cpu;
+
+    if (!settings.enabled || !configured_rate || time_msec() < next_run) {
+        return false;
+    }
+    next_run = time_msec() + SFLOW_GOVERNOR_INTERVAL;
+
+    cpu = get_cpu_usage();
+    drops = sflow_governor_copp_drops();
+
+    if (drops || cpu > settings.cpu_high) {
+        effective_rate = sflow_governor_clamp((uint64_t) effective_rate * 2);
+        n_calm = 0;
+    } else if (cpu >= 0 && cpu < settings.cpu_low) {
+        if (++n_calm >= SFLOW_GOVERNOR_CALM_INTERVALS) {
+            effective_rate = sflow_governor_clamp(effective_rate / 2);
+            n_calm = 0;
+        }
+    } else {
+        n_calm = 0;
+    }
+
+    if (effective_rate == old_rate) {
+        return false;
+    }
+    VLOG_INFO("sFlow sampling rate %"PRIu32" -> %"PRIu32" (configured "
+              "%"PRIu32", cpu %d%%, %"PRIu64" samples dropped)",
+              old_rate, effective_rate, configured_rate, cpu, drops);
+    return true;
+}
+
+void
+sflow_governor_wait(void)
+{
+    if (settings.enabled && configured_rate) {
+        poll_timer_wait_until(next_run);
+    }
+}
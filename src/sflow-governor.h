@@ -0,0 +1,70 @@
+/* Copyright (c) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VSWITCHD_SFLOW_GOVERNOR_H
+#define VSWITCHD_SFLOW_GOVERNOR_H 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* sFlow sampling governor.
+ *
+ * With "sflow-governor" set to true in the Open_vSwitch other_config column,
+ * the sampling rate passed to ofproto is no longer the configured one but an
+ * effective rate that follows the load of SwitchD.  Every
+ * SFLOW_GOVERNOR_INTERVAL msec the governor reads the CPU usage of SwitchD
+ * and the drops of the sFlow samples COPP class:
+ *
+ *   - On any drop, or with the CPU usage above "sflow-governor-cpu-high"
+ *     (percent), the rate doubles: one packet out of twice as many is
+ *     sampled.
+ *
+ *   - Once the CPU usage stayed below "sflow-governor-cpu-low" without drops
+ *     for SFLOW_GOVERNOR_CALM_INTERVALS intervals in a row, the rate halves.
+ *
+ * In between, the rate holds.  The effective rate stays within
+ * "sflow-governor-min-sampling" and "sflow-governor-max-sampling", which
+ * default to the configured rate and SFLOW_GOVERNOR_DFLT_MAX_FACTOR times it.
+ * It starts from the configured rate, and again each time the latter
+ * changes.
+ *
+ * The sFlow datagrams carry the sampling rate of every sample, so collectors
+ * scale the effective rate correctly.  SwitchD also publishes it in the
+ * sFlow statistics column.
+ *
+ * sflow_governor_configure: reads the settings above from 'other_config'.
+ *
+ * sflow_governor_rate: returns the sampling rate to apply for the configured
+ * rate 'configured', which is returned as is when the governor is disabled.
+ *
+ * sflow_governor_run: adjusts the effective rate when an interval elapsed.
+ * Returns true if it changed, in which case the sFlow options must be applied
+ * again.
+ *
+ * sflow_governor_wait: wakes up the main loop for the next interval.
+ */
+
+#define SFLOW_GOVERNOR_INTERVAL 5000            /* msec */
+#define SFLOW_GOVERNOR_CALM_INTERVALS 3
+#define SFLOW_GOVERNOR_DFLT_MAX_FACTOR 64
+
+struct smap;
+
+void sflow_governor_configure(const struct smap *other_config);
+uint32_t sflow_governor_rate(uint32_t configured);
+bool sflow_governor_run(void);
+void sflow_governor_wait(void);
+
+#endif /* sflow-governor.h */
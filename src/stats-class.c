@@ -0,0 +1,142 @@
+/* Copyright (c) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <config.h>
+
+#include "stats-class.h"
+
+#include <string.h>
+
+#include "smap.h"
+#include "util.h"
+#include "vswitch-idl.h"
+#include "openvswitch/vlog.h"
+
+#include "openswitch-idl.h"
+#include "openswitch-dflt.h"
+
+VLOG_DEFINE_THIS_MODULE(stats_class);
+
+/* Default and smallest accepted interval of the fast class, in msec. */
+#define STATS_CLASS_DFLT_FAST_INTERVAL 1000
+#define STATS_CLASS_MIN_FAST_INTERVAL  1000
+
+/* Default interval of the slow class, in msec. */
+#define STATS_CLASS_DFLT_SLOW_INTERVAL 60000
+
+static const char *stats_class_names[N_STATS_CLASSES] = {
+    [STATS_CLASS_FAST] = "fast",
+    [STATS_CLASS_NORMAL] = "normal",
+    [STATS_CLASS_SLOW] = "slow",
+};
+
+static int stats_class_intervals[N_STATS_CLASSES] = {
+    [STATS_CLASS_FAST] = STATS_CLASS_DFLT_FAST_INTERVAL,
+    [STATS_CLASS_NORMAL] = DFLT_SYSTEM_OTHER_CONFIG_STATS_UPDATE_INTERVAL,
+    [STATS_CLASS_SLOW] = STATS_CLASS_DFLT_SLOW_INTERVAL,
+};
+
+/* Reads the interval of each polling class from the Open_vSwitch
+ * 'other_config'.  The normal class follows "stats-update-interval" and
+ * keeps its lower bound; the fast class may go below it and the slow class
+ * may not. */
+void
+stats_class_configure(const struct smap *other_config)
+{
+    int normal, fast, slow;
+
+    normal = MAX(smap_get_int(other_config, "stats-update-interval",
+                              DFLT_SYSTEM_OTHER_CONFIG_STATS_UPDATE_INTERVAL),
+                 DFLT_SYSTEM_OTHER_CONFIG_STATS_UPDATE_INTERVAL);
+    fast = smap_get_int(other_config, "stats-update-interval-fast",
+                        STATS_CLASS_DFLT_FAST_INTERVAL);
+    fast = MIN(MAX(fast, STATS_CLASS_MIN_FAST_INTERVAL), normal);
+    slow = MAX(smap_get_int(other_config, "stats-update-interval-slow",
+                            STATS_CLASS_DFLT_SLOW_INTERVAL), normal);
+
+    stats_class_intervals[STATS_CLASS_FAST] = fast;
+    stats_class_intervals[STATS_CLASS_NORMAL] = normal;
+    stats_class_intervals[STATS_CLASS_SLOW] = slow;
+}
+
+int
+stats_class_interval(enum stats_class class)
+{
+    return stats_class_intervals[class];
+}
+
+const char *
+stats_class_to_string(enum stats_class class)
+{
+    return stats_class_names[class];
+}
+
+static bool
+stats_class_from_string(const char *s, enum stats_class *class)
+{
+    int i;
+
+    for (i = 0; i < N_STATS_CLASSES; i++) {
+        if (!strcmp(s, stats_class_names[i])) {
+            *class = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Returns the polling class of the interface 'if_cfg' on port 'port_cfg'.
+ * 'port_cfg' may be NULL for interfaces that are not part of a port. */
+enum stats_class
+stats_class_get(const struct ovsrec_interface *if_cfg,
+                const struct ovsrec_port *port_cfg)
+{
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+    enum stats_class class;
+    const char *s;
+
+    s = smap_get(&if_cfg->other_config, "stats-poll-class");
+    if (!s && port_cfg) {
+        s = smap_get(&port_cfg->other_config, "stats-poll-class");
+    }
+    if (s) {
+        if (stats_class_from_string(s, &class)) {
+            return class;
+        }
+        VLOG_WARN_RL(&rl, "interface %s: unknown stats-poll-class %s",
+                     if_cfg->name, s);
+    }
+
+    if (if_cfg->type
+        && !strcmp(if_cfg->type, OVSREC_INTERFACE_TYPE_VLANSUBINT)) {
+        return STATS_CLASS_SLOW;
+    }
+    return STATS_CLASS_NORMAL;
+}
+
+/* Returns true if statistics polled on the schedule '*next' are due at
+ * 'now', in which case '*next' is advanced by the interval of 'class'.
+ * Polls up to 'slack' msec early are accepted so that a schedule that
+ * drifts slightly behind its caller's timer does not skip a whole round. */
+bool
+stats_class_due(long long int *next, enum stats_class class,
+                long long int now, int slack)
+{
+    if (now + slack < *next) {
+        return false;
+    }
+    *next = now + stats_class_intervals[class];
+    return true;
+}
@@ -0,0 +1,52 @@
+/* Copyright (c) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VSWITCHD_STATS_CLASS_H
+#define VSWITCHD_STATS_CLASS_H 1
+
+#include <stdbool.h>
+
+/* Interface statistics polling classes.
+ *
+ * Every interface belongs to one polling class, which decides how often its
+ * statistics are collected.  The class is taken from "stats-poll-class" in
+ * the Interface other_config column, then in the Port other_config column,
+ * and otherwise from the interface type (subinterfaces default to "slow").
+ *
+ * The interval of each class comes from the Open_vSwitch other_config
+ * column: "stats-update-interval-fast", "stats-update-interval" for the
+ * normal class and "stats-update-interval-slow". */
+
+struct ovsrec_interface;
+struct ovsrec_port;
+struct smap;
+
+enum stats_class {
+    STATS_CLASS_FAST,
+    STATS_CLASS_NORMAL,
+    STATS_CLASS_SLOW,
+    N_STATS_CLASSES
+};
+
+void stats_class_configure(const struct smap *other_config);
+int stats_class_interval(enum stats_class);
+enum stats_class stats_class_get(const struct ovsrec_interface *,
+                                 const struct ovsrec_port *);
+const char *stats_class_to_string(enum stats_class);
+
+bool stats_class_due(long long int *next, enum stats_class,
+                     long long int now, int slack);
+
+#endif /* stats-class.h */
@@ -26,6 +26,7 @@
 #include "hash.h"
 #include "hmap.h"
 #include "hmapx.h"
+#include "iface-rate.h"
 #include "list.h"
 #include "netdev.h"
 #include "poll-loop.h"
@@ -34,7 +35,10 @@
 #include "smap.h"
 #include "sset.h"
 #include "stats-blocks.h"
+#include "stats-class.h"
 #include "timeval.h"
+#include "txn-coalescer.h"
+#include "unixctl.h"
 #include "util.h"
 #include "vswitch-idl.h"
 #include "openvswitch/vlog.h"
@@ -45,12 +49,18 @@
 VLOG_DEFINE_THIS_MODULE(subsystem);
 
 COVERAGE_DEFINE(subsystem_reconfigure);
+COVERAGE_DEFINE(subsystem_link_event);
 
 /* Each time this timer expires, the interface statistics
  * are pushed to the database. */
 static int stats_timer_interval;
 static long long int stats_timer = LLONG_MIN;
 
+/* The timer runs at the interval of the fastest polling class seen during
+ * the previous round; each interface is then polled when its own class is
+ * due. */
+static enum stats_class stats_cycle_class = STATS_CLASS_NORMAL;
+
 struct iface {
     /* These members are always valid.
      * They are immutable: they never change between iface_create() and
@@ -60,6 +70,12 @@ struct iface {
     char *name;                  /* Host network device name. */
     struct netdev *netdev;       /* Network device. */
     uint64_t change_seq;
+    struct iface_rate *rate;     /* Smoothed rx/tx rates. */
+    long long int stats_due;     /* Next statistics poll, in msec. */
+    bool carrier;                /* Last link state written to the DB. */
+    long long int link_detected; /* When a carrier change was first seen,
+                                  * in usec, or 0 if none is pending. */
+    struct subsystem_sflow_stats sflow; /* Counted in 'sflow_totals'. */
 
     const struct ovsrec_interface *cfg;
 };
@@ -82,9 +98,44 @@ static struct hmap all_subsystems = HMAP_INITIALIZER(&all_subsystems);
 /* OVSDB IDL used to obtain configuration. */
 extern struct ovsdb_idl *idl;
 
+/* Link state changes are written by subsystem_link_run(), ahead of the rest
+ * of the main loop, in a transaction of their own.  'link_pending' holds the
+ * detection time (in usec) of each change carried by 'link_txn', so that the
+ * detection to commit latency can be recorded once the commit completes.
+ * A change is detected by link_detect(), which also runs while 'link_txn' is
+ * in flight, so that the wait for it counts towards the latency. */
+static struct ovsdb_idl_txn *link_txn;
+static long long int *link_pending;
+static size_t n_link_pending, allocated_link_pending;
+
+/* Upper bounds, in usec, of the link latency histogram buckets.  The last
+ * bucket counts everything above the last bound. */
+static const long long int link_latency_bounds[] = {
+    500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+    1000000
+};
+#define N_LINK_LATENCY_BUCKETS (ARRAY_SIZE(link_latency_bounds) + 1)
+
+struct link_latency {
+    unsigned long long int buckets[N_LINK_LATENCY_BUCKETS];
+    unsigned long long int n_events;   /* Events committed. */
+    unsigned long long int n_failed;   /* Events whose commit failed. */
+    long long int total_usec;
+    long long int max_usec;
+};
+static struct link_latency link_latency;
+
 /* Most recently processed IDL sequence number. */
 static unsigned int idl_seqno;
 
+/* Subsystem status and statistics are written by 'status_writer' in the
+ * transaction coalesced at the end of the main loop iteration.  It is only
+ * requested when there is something to write, and not while the previous
+ * write is still in flight.  'status_pending' and 'stats_pending' tell it
+ * what to write. */
+static bool status_pending;
+static bool stats_pending;
+
 static void add_del_subsystems(const struct ovsrec_open_vswitch *);
 static void subsystem_create(const struct ovsrec_subsystem *);
 static void subsystem_destroy(struct subsystem *);
@@ -108,6 +159,29 @@ static int iface_set_netdev_hw_intf_config(const struct ovsrec_interface *,
 static void iface_refresh_netdev_status(struct iface *iface);
 static void iface_refresh_stats(struct iface *iface);
 
+/* sFlow sample counters summed over every interface, updated as each one is
+ * refreshed, so that they are published without walking the interfaces. */
+static struct subsystem_sflow_stats sflow_totals;
+static unixctl_cb_func subsystem_unixctl_link_latency;
+
+/* Returns true if the netdev of any subsystem interface changed since its
+ * status was last written. */
+static bool
+status_update_needed(void)
+{
+    struct subsystem *ss;
+    struct iface *iface;
+
+    HMAP_FOR_EACH (ss, node, &all_subsystems) {
+        HMAP_FOR_EACH (iface, name_node, &ss->iface_by_name) {
+            if (iface->change_seq != netdev_get_change_seq(iface->netdev)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 static void
 run_status_update(void)
 {
@@ -121,50 +195,186 @@ run_status_update(void)
     }
 }
 
-static void
-run_stats_update(void)
+/* Applies the statistics configuration in 'cfg' and returns true if the
+ * statistics timer expired. */
+static bool
+stats_update_needed(const struct ovsrec_open_vswitch *cfg)
 {
     int stats_interval;
-    struct subsystem *ss;
-    struct iface *iface;
-    const struct ovsrec_open_vswitch *cfg = ovsrec_open_vswitch_first(idl);
-    struct stats_blk_params sblk = {0};
 
-    /* Statistics update interval should always be greater than or equal to
-     * 5000 ms. */
-    stats_interval = MAX(smap_get_int(&cfg->other_config,
-                                      "stats-update-interval",
-                                      DFLT_SYSTEM_OTHER_CONFIG_STATS_UPDATE_INTERVAL),
-                                      DFLT_SYSTEM_OTHER_CONFIG_STATS_UPDATE_INTERVAL);
+    if (!cfg) {
+        return false;
+    }
+
+    stats_class_configure(&cfg->other_config);
+    stats_interval = stats_class_interval(stats_cycle_class);
     if (stats_timer_interval != stats_interval) {
         stats_timer_interval = stats_interval;
         stats_timer = LLONG_MIN;
     }
+    iface_rate_set_default_window(&cfg->other_config);
+
+    return time_msec() >= stats_timer;
+}
+
+/* Fills 'iface_ports' with the Port row of each interface, by interface
+ * name, for the Port level "stats-poll-class" of the LAG and uplink system
+ * interfaces. */
+static void
+iface_ports_init(struct shash *iface_ports)
+{
+    const struct ovsrec_port *port_cfg;
+    size_t i;
+
+    shash_init(iface_ports);
+    OVSREC_PORT_FOR_EACH (port_cfg, idl) {
+        for (i = 0; i < port_cfg->n_interfaces; i++) {
+            shash_add_once(iface_ports, port_cfg->interfaces[i]->name,
+                           port_cfg);
+        }
+    }
+}
+
+static void
+run_stats_update(void)
+{
+    struct subsystem *ss;
+    struct iface *iface;
+    struct stats_blk_params sblk = {0};
+    enum stats_class next_class = STATS_CLASS_NORMAL;
+    long long int now = time_msec();
+    struct shash iface_ports;
 
-    if (time_msec() >= stats_timer) {
+    iface_ports_init(&iface_ports);
 
-        sblk.idl = idl;
-        sblk.idl_seqno = idl_seqno;
-        execute_stats_block(&sblk, STATS_SUBSYSTEM_BEGIN);
-        HMAP_FOR_EACH (ss, node, &all_subsystems) {
-            execute_stats_block(&sblk, STATS_PER_SUBSYSTEM);
-            HMAP_FOR_EACH (iface, name_node, &ss->iface_by_name) {
-                iface_refresh_stats(iface);
+    sblk.idl = idl;
+    sblk.idl_seqno = idl_seqno;
+    execute_stats_block(&sblk, STATS_SUBSYSTEM_BEGIN);
+    HMAP_FOR_EACH (ss, node, &all_subsystems) {
+        execute_stats_block(&sblk, STATS_PER_SUBSYSTEM);
+        HMAP_FOR_EACH (iface, name_node, &ss->iface_by_name) {
+            enum stats_class class;
 
-                /* Statistics-callback for system interfaces.
-                   Note: non-system interfaces are handled in bridge.c. */
-                if (iface->netdev != NULL) {
-                    sblk.netdev = iface->netdev;
-                    sblk.cfg = iface->cfg;
-                    execute_stats_block(&sblk, STATS_PER_SUBSYSTEM_NETDEV);
-                }
+            class = stats_class_get(iface->cfg,
+                                    shash_find_data(&iface_ports,
+                                                    iface->cfg->name));
+
+            next_class = MIN(next_class, class);
+            if (!stats_class_due(&iface->stats_due, class, now,
+                                 stats_timer_interval / 2)) {
+                continue;
+            }
+            iface_refresh_stats(iface);
+
+            /* Statistics-callback for system interfaces.
+               Note: non-system interfaces are handled in bridge.c. */
+            if (iface->netdev != NULL) {
+                sblk.netdev = iface->netdev;
+                sblk.cfg = iface->cfg;
+                sblk.rates = iface_rate_get(iface->rate);
+                execute_stats_block(&sblk, STATS_PER_SUBSYSTEM_NETDEV);
             }
-            sblk.netdev = NULL;
         }
+        sblk.netdev = NULL;
+        sblk.rates = NULL;
+    }
 
-        execute_stats_block(&sblk, STATS_SUBSYSTEM_END);
-        stats_timer = time_msec() + stats_timer_interval;
-        poll_timer_wait_until(stats_timer);
+    execute_stats_block(&sblk, STATS_SUBSYSTEM_END);
+    shash_destroy(&iface_ports);
+    stats_cycle_class = next_class;
+    stats_timer_interval = stats_class_interval(stats_cycle_class);
+    stats_timer = time_msec() + stats_timer_interval;
+}
+
+static void
+link_latency_record(long long int usec)
+{
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(link_latency_bounds); i++) {
+        if (usec <= link_latency_bounds[i]) {
+            break;
+        }
+    }
+    link_latency.buckets[i]++;
+    link_latency.n_events++;
+    link_latency.total_usec += usec;
+    link_latency.max_usec = MAX(link_latency.max_usec, usec);
+}
+
+/* Finishes 'link_txn' once its commit completed with 'status'. */
+static void
+link_txn_done(enum ovsdb_idl_txn_status status)
+{
+    long long int now = time_usec();
+    size_t i;
+
+    if (status == TXN_SUCCESS || status == TXN_UNCHANGED) {
+        for (i = 0; i < n_link_pending; i++) {
+            link_latency_record(now - link_pending[i]);
+        }
+    } else {
+        /* The regular status update rewrites link_state anyway. */
+        link_latency.n_failed += n_link_pending;
+    }
+    n_link_pending = 0;
+
+    ovsdb_idl_txn_destroy(link_txn);
+    link_txn = NULL;
+}
+
+static void
+subsystem_unixctl_link_latency(struct unixctl_conn *conn,
+                               int argc OVS_UNUSED,
+                               const char *argv[] OVS_UNUSED,
+                               void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    size_t i;
+
+    ds_put_format(&ds, "link events committed: %llu, failed: %llu\n",
+                  link_latency.n_events, link_latency.n_failed);
+    if (link_latency.n_events) {
+        ds_put_format(&ds, "average: %lld us, max: %lld us\n",
+                      link_latency.total_usec
+                      / (long long int) link_latency.n_events,
+                      link_latency.max_usec);
+    }
+    for (i = 0; i < N_LINK_LATENCY_BUCKETS; i++) {
+        if (i < ARRAY_SIZE(link_latency_bounds)) {
+            ds_put_format(&ds, "<= %7lld us: %llu\n",
+                          link_latency_bounds[i], link_latency.buckets[i]);
+        } else {
+            ds_put_format(&ds, " > %7lld us: %llu\n",
+                          link_latency_bounds[i - 1], link_latency.buckets[i]);
+        }
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+}
+
+/* Stamps the interfaces whose carrier changed from the value last written
+ * with the current time, unless they already carry a pending change. */
+static void
+link_detect(void)
+{
+    struct subsystem *ss;
+    struct iface *iface;
+    long long int now = 0;
+
+    HMAP_FOR_EACH (ss, node, &all_subsystems) {
+        HMAP_FOR_EACH (iface, name_node, &ss->iface_by_name) {
+            if (iface->link_detected
+                || iface->change_seq == netdev_get_change_seq(iface->netdev)
+                || netdev_get_carrier(iface->netdev) == iface->carrier) {
+                continue;
+            }
+            if (!now) {
+                now = time_usec();
+            }
+            iface->link_detected = now;
+        }
     }
 }
 
@@ -173,6 +383,86 @@ void
 subsystem_init(void)
 {
     idl_seqno = ovsdb_idl_get_seqno(idl);
+
+    unixctl_command_register("subsystem/link-latency", "", 0, 0,
+                             subsystem_unixctl_link_latency, NULL);
+}
+
+/* Writes carrier changes of subsystem interfaces to the database in a small
+ * transaction of their own.  This is meant to run first in the main loop, so
+ * that link events do not wait behind reconfiguration and statistics work.
+ * The full status of these interfaces is still refreshed by subsystem_run(). */
+void
+subsystem_link_run(void)
+{
+    struct subsystem *ss;
+    struct iface *iface;
+    long long int now;
+
+    if (!ovsdb_idl_has_lock(idl)) {
+        return;
+    }
+
+    link_detect();
+
+    /* Do not start a new update while the previous one is in flight. */
+    if (link_txn) {
+        enum ovsdb_idl_txn_status status = ovsdb_idl_txn_commit(link_txn);
+
+        if (status == TXN_INCOMPLETE) {
+            return;
+        }
+        link_txn_done(status);
+    }
+
+    now = time_usec();
+    HMAP_FOR_EACH (ss, node, &all_subsystems) {
+        HMAP_FOR_EACH (iface, name_node, &ss->iface_by_name) {
+            int64_t link_resets;
+            bool carrier;
+
+            /* Only netdevs that changed since the last status refresh. */
+            if (iface->change_seq == netdev_get_change_seq(iface->netdev)) {
+                continue;
+            }
+
+            carrier = netdev_get_carrier(iface->netdev);
+            if (carrier == iface->carrier) {
+                /* The carrier flapped back before it was written. */
+                iface->link_detected = 0;
+                continue;
+            }
+
+            if (!link_txn) {
+                link_txn = ovsdb_idl_txn_create(idl);
+            }
+            iface->carrier = carrier;
+            ovsrec_interface_set_link_state(iface->cfg,
+                                            carrier ?
+                                            OVSREC_INTERFACE_LINK_STATE_UP :
+                                            OVSREC_INTERFACE_LINK_STATE_DOWN);
+            link_resets = netdev_get_carrier_resets(iface->netdev);
+            ovsrec_interface_set_link_resets(iface->cfg, &link_resets, 1);
+
+            if (n_link_pending >= allocated_link_pending) {
+                link_pending = x2nrealloc(link_pending,
+                                          &allocated_link_pending,
+                                          sizeof *link_pending);
+            }
+            link_pending[n_link_pending++] = (iface->link_detected
+                                              ? iface->link_detected : now);
+            iface->link_detected = 0;
+            COVERAGE_INC(subsystem_link_event);
+        }
+    }
+
+    if (link_txn) {
+        enum ovsdb_idl_txn_status status = ovsdb_idl_txn_commit(link_txn);
+
+        if (status != TXN_INCOMPLETE) {
+            link_txn_done(status);
+        }
+    }
 }
 
 void
@@ -300,12 +590,28 @@ add_del_subsystems(const struct ovsrec_open_vswitch *cfg)
     shash_destroy(&new_ss);
 }
 
+static void
+subsystem_status_write(struct ovsdb_idl_txn *txn OVS_UNUSED,
+                       void *aux OVS_UNUSED)
+{
+    if (status_pending) {
+        run_status_update();
+        status_pending = false;
+    }
+    if (stats_pending) {
+        run_stats_update();
+        stats_pending = false;
+    }
+}
+
+static struct txn_writer status_writer =
+    TXN_WRITER_INITIALIZER("subsystem", subsystem_status_write, NULL, NULL);
+
 void
 subsystem_run(void)
 {
     static struct ovsrec_open_vswitch null_cfg;
     const struct ovsrec_open_vswitch *cfg;
-    struct ovsdb_idl_txn *txn;
 
     if (!ovsdb_idl_has_lock(idl)) {
         return;
@@ -313,23 +619,49 @@ subsystem_run(void)
 
     cfg = ovsrec_open_vswitch_first(idl);
 
-    txn = ovsdb_idl_txn_create(idl);
-
+    /* Reconfiguration always runs, so that no stale row is used below.  The
+     * interfaces it creates write their initial status and statistics. */
     if (ovsdb_idl_get_seqno(idl) != idl_seqno) {
+        struct ovsdb_idl_txn *txn = ovsdb_idl_txn_create(idl);
+
         subsystem_reconfigure(cfg ? cfg : &null_cfg);
         idl_seqno = ovsdb_idl_get_seqno(idl);
+
+        ovsdb_idl_txn_commit(txn);
+        ovsdb_idl_txn_destroy(txn);
     }
 
-    run_status_update();
-    run_stats_update();
+    /* Rate limit the update.  Do not start a new update if the previous one
+     * is not done. */
+    if (txn_writer_is_busy(&status_writer)) {
+        return;
+    }
 
-    ovsdb_idl_txn_commit(txn);
-    ovsdb_idl_txn_destroy(txn);
+    status_pending = status_update_needed();
+    stats_pending = stats_update_needed(cfg);
+    if (status_pending || stats_pending) {
+        txn_writer_request(&status_writer);
+    }
 }
 
 void
 subsystem_wait(void)
 {
+    if (link_txn) {
+        ovsdb_idl_txn_wait(link_txn);
+    }
+
+    /* netdev_run() ran since subsystem_link_run(), so this is the earliest
+     * point at which a new carrier change can be seen. */
+    if (ovsdb_idl_has_lock(idl)) {
+        link_detect();
+    }
+
+    /* txn_coalescer_wait() waits for the write in flight, if any. */
+    if (!txn_writer_is_busy(&status_writer)
+        && !hmap_is_empty(&all_subsystems)) {
+        poll_timer_wait_until(stats_timer);
+    }
 }
 
 /* Subsystem reconfiguration functions. */
@@ -494,6 +826,7 @@ iface_create(struct subsystem *ss, const struct ovsrec_interface *iface_cfg)
     iface->name = xstrdup(iface_cfg->name);
     iface->netdev = netdev;
     iface->cfg = iface_cfg;
+    iface->rate = iface_rate_create();
 
     iface_refresh_netdev_status(iface);
     iface_refresh_stats(iface);
@@ -501,6 +834,7 @@ iface_create(struct subsystem *ss, const struct ovsrec_interface *iface_cfg)
     if (iface->netdev != NULL) {
         sblk.netdev = iface->netdev;
         sblk.cfg = iface_cfg;
+        sblk.rates = iface_rate_get(iface->rate);
         execute_stats_block(&sblk, STATS_SUBSYSTEM_CREATE_NETDEV);
     }
 
@@ -519,6 +853,9 @@ iface_destroy(struct iface *iface)
          * used as opposed to netdev_close */
         netdev_remove(iface->netdev);
 
+        sflow_totals.ingress_packets -= iface->sflow.ingress_packets;
+        sflow_totals.egress_packets -= iface->sflow.egress_packets;
+        iface_rate_destroy(iface->rate);
         free(iface->name);
         free(iface);
     }
@@ -590,7 +927,9 @@ iface_refresh_netdev_status(struct iface *iface)
     }
 
     /* link_state */
-    link_state = netdev_get_carrier(iface->netdev) ?
+    iface->carrier = netdev_get_carrier(iface->netdev);
+    iface->link_detected = 0;
+    link_state = iface->carrier ?
                     OVSREC_INTERFACE_LINK_STATE_UP :
                     OVSREC_INTERFACE_LINK_STATE_DOWN;
     ovsrec_interface_set_link_state(iface->cfg, link_state);
@@ -647,6 +986,29 @@ iface_refresh_netdev_status(struct iface *iface)
     }
 }
 
+/* Replaces the sFlow counters of 'iface' in 'sflow_totals' by the ones in
+ * 'stats'. */
+static void
+iface_update_sflow_totals(struct iface *iface,
+                          const struct netdev_stats *stats)
+{
+    uint64_t ingress = (stats->sflow_ingress_packets != UINT64_MAX
+                        ? stats->sflow_ingress_packets : 0);
+    uint64_t egress = (stats->sflow_egress_packets != UINT64_MAX
+                       ? stats->sflow_egress_packets : 0);
+
+    sflow_totals.ingress_packets += ingress - iface->sflow.ingress_packets;
+    sflow_totals.egress_packets += egress - iface->sflow.egress_packets;
+    iface->sflow.ingress_packets = ingress;
+    iface->sflow.egress_packets = egress;
+}
+
+void
+subsystem_get_sflow_stats(struct subsystem_sflow_stats *stats)
+{
+    *stats = sflow_totals;
+}
+
 static void
 iface_refresh_stats(struct iface *iface)
 {
@@ -694,8 +1056,8 @@ iface_refresh_stats(struct iface *iface)
 #define IFACE_STAT(MEMBER, NAME) + 1
     enum { N_IFACE_STATS = IFACE_STATS };
 #undef IFACE_STAT
-    int64_t values[N_IFACE_STATS];
-    char *keys[N_IFACE_STATS];
+    int64_t values[N_IFACE_STATS + IFACE_RATE_N_KEYS];
+    char *keys[N_IFACE_STATS + IFACE_RATE_N_KEYS];
     int n;
 
     struct netdev_stats stats;
@@ -704,6 +1066,7 @@ iface_refresh_stats(struct iface *iface)
      * all-1s, and we will deal with that correctly below. */
     memset(&stats, 0, sizeof(struct netdev_stats));
     netdev_get_stats(iface->netdev, &stats);
+    iface_update_sflow_totals(iface, &stats);
 
     /* Copy statistics into keys[] and values[]. */
     n = 0;
@@ -717,6 +1080,10 @@ iface_refresh_stats(struct iface *iface)
 #undef IFACE_STAT
     ovs_assert(n <= N_IFACE_STATS);
 
+    /* Publish the smoothed rates next to the raw counters. */
+    iface_rate_update(iface->rate, &stats, iface->cfg);
+    n += iface_rate_put_stats(iface->rate, &keys[n], &values[n]);
+
     ovsrec_interface_set_statistics(iface->cfg, keys, values, n);
 #undef IFACE_STATS
 }
@@ -17,10 +17,22 @@
 #ifndef VSWITCHD_SUBSYSTEM_H
 #define VSWITCHD_SUBSYSTEM_H 1
 
+#include <stdint.h>
+
+/* Sums of the sFlow sample counters of the subsystem interfaces, as of their
+ * last statistics refresh. */
+struct subsystem_sflow_stats {
+    uint64_t ingress_packets;
+    uint64_t egress_packets;
+};
+
 void subsystem_init(void);
 void subsystem_exit(void);
 
+void subsystem_link_run(void);
 void subsystem_run(void);
 void subsystem_wait(void);
 
+void subsystem_get_sflow_stats(struct subsystem_sflow_stats *);
+
 #endif /* subsystem.h */
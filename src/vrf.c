@@ -17,6 +17,7 @@
 #include <errno.h>
 #include "bridge.h"
 #include "vrf.h"
+#include "coverage.h"
 #include "hash.h"
 #include "shash.h"
 #include "ofproto/ofproto.h"
@@ -25,12 +26,19 @@
 
 VLOG_DEFINE_THIS_MODULE(vrf);
 
+COVERAGE_DEFINE(vrf_route_held);
+COVERAGE_DEFINE(vrf_route_released);
+
 extern struct ovsdb_idl *idl;
 extern unsigned int idl_seqno;
 
 /* global ecmp config (not per VRF) - default values set here */
 struct ecmp ecmp_config = {true, true, true, true, true, true};
 
+/* While set, new routes none of whose nexthops is resolved are held back
+ * instead of being programmed to copy to CPU, see vrf_set_route_hold(). */
+static bool route_hold = false;
+
 static struct nexthop * vrf_nexthop_add(struct vrf *vrf, struct route *route,
                                         const struct ovsrec_nexthop *nh_row);
 
@@ -65,6 +73,13 @@ static struct nexthop * vrf_nexthop_add(struct vrf *vrf, struct route *route,
  * neighbor IP will be updated in ofproto with the route->nexthop marked as MAC
  * unresolved.
  *
+ * On a cold start, routes are added while the neighbors of their nexthops are
+ * still being learned, so most of them would be programmed unresolved and then
+ * reprogrammed once per neighbor.  While route hold is enabled, a new route
+ * with no resolved nexthop is only cached: it is programmed by the first
+ * neighbor that resolves one of its nexthops, or unresolved by
+ * vrf_release_held_routes() when the hold ends.
+ *
  * Note: Nexthops are assumed to have either IP or port, but not both.
  */
 
@@ -140,6 +155,7 @@ vrf_ofproto_route_add(struct vrf *vrf, struct ofproto_route *ofp_route,
 
     ofp_route->family = route->is_ipv6 ? OFPROTO_ROUTE_IPV6 : OFPROTO_ROUTE_IPV4;
     ofp_route->prefix = route->prefix;
+    route->held = false;
 
     if ((rc = vrf_l3_route_action(vrf, OFPROTO_ROUTE_ADD, ofp_route)) == 0) {
         VLOG_DBG("Route added for %s", route->prefix);
@@ -214,6 +230,14 @@ vrf_ofproto_route_delete(struct vrf *vrf, struct ofproto_route *ofp_route,
     int rc = 0;
     enum ofproto_route_action action;
 
+    if (route->held) {
+        /* Never programmed, only free the temp info */
+        for (i = 0; i < ofp_route->n_nexthops; i++) {
+            free(ofp_route->nexthops[i].id);
+        }
+        return;
+    }
+
     ofp_route->family = route->is_ipv6 ? OFPROTO_ROUTE_IPV6 : OFPROTO_ROUTE_IPV4;
     ofp_route->prefix = route->prefix;
     action = del_route ? OFPROTO_ROUTE_DELETE : OFPROTO_ROUTE_DELETE_NH;
@@ -241,6 +265,32 @@ vrf_ofproto_route_delete(struct vrf *vrf, struct ofproto_route *ofp_route,
     }
 }
 
+/* Returns true if the held 'route' stays held instead of being programmed
+ * with the nexthops in 'ofp_route', that is if none of them is resolved, in
+ * which case their temp info is freed. */
+static bool
+vrf_route_stays_held(struct route *route, struct ofproto_route *ofp_route)
+{
+    int i;
+
+    if (!route->held) {
+        return false;
+    }
+    for (i = 0; i < ofp_route->n_nexthops; i++) {
+        if (ofp_route->nexthops[i].type == OFPROTO_NH_PORT
+            || ofp_route->nexthops[i].state == OFPROTO_NH_RESOLVED) {
+            return false;
+        }
+    }
+
+    COVERAGE_INC(vrf_route_held);
+    VLOG_DBG("Holding route %s, no resolved nexthop", route->prefix);
+    for (i = 0; i < ofp_route->n_nexthops; i++) {
+        free(ofp_route->nexthops[i].id);
+    }
+    return true;
+}
+
 /* Update an ofproto route with the neighbor as [un]resolved. */
 void
 vrf_ofproto_update_route_with_neighbor(struct vrf *vrf,
@@ -257,6 +307,10 @@ vrf_ofproto_update_route_with_neighbor(struct vrf *vrf,
                             &vrf->all_nexthops) {
         /* match the neighbor's IP address */
         if (nh->ip_addr && (strcmp(nh->ip_addr, neighbor->ip_address) == 0)) {
+            if (nh->route->held && !resolved) {
+                /* Not in ofproto yet, nothing to update */
+                continue;
+            }
             /* Fill ofp_route for PD and free after returning in
              * vrf_ofproto_route_add */
             ofp_route.nexthops[0].state =
@@ -571,6 +625,7 @@ vrf_route_add(struct vrf *vrf, const struct ovsrec_route *route_row)
     route = xzalloc(sizeof(*route));
     route->prefix = xstrdup(route_row->prefix);
     route->from = xstrdup(route_row->from);
+    route->held = route_hold;
     if (route_row->address_family &&
         (strcmp(route_row->address_family, OVSREC_NEIGHBOR_ADDRESS_FAMILY_IPV6)
                                                                         == 0)) {
@@ -605,7 +660,8 @@ vrf_route_add(struct vrf *vrf, const struct ovsrec_route *route_row)
     }
 
     /* If got any valid/selected NH, pass it to asic */
-    if (ofp_route.n_nexthops > 0) {
+    if (ofp_route.n_nexthops > 0
+        && !vrf_route_stays_held(route, &ofp_route)) {
         vrf_ofproto_route_add(vrf, &ofp_route, route);
     }
 
@@ -706,7 +762,8 @@ vrf_route_modify(struct vrf *vrf, struct route *route,
             }
         }
     }
-    if (ofp_route.n_nexthops > 0) {
+    if (ofp_route.n_nexthops > 0
+        && !vrf_route_stays_held(route, &ofp_route)) {
         vrf_ofproto_route_add(vrf, &ofp_route, route);
     }
 
@@ -931,6 +988,57 @@ vrf_reconfigure_routes(struct vrf *vrf)
      * NH as any of the ports in the deleted VRF */
 }
 
+/* Enables or disables route hold.  While enabled, new routes none of whose
+ * nexthops is resolved are cached but not programmed, so that on a cold start
+ * each route is programmed once, with the neighbors known by then. */
+void
+vrf_set_route_hold(bool hold)
+{
+    route_hold = hold;
+}
+
+/* Programs the routes of 'vrf' still held, with their nexthops as resolved
+ * now.  Like vrf_ofproto_add_resolved_nh(), a route is programmed with all of
+ * its resolved nexthops or, if none is resolved, with one of them to copy to
+ * CPU.  Returns the number of routes programmed. */
+int
+vrf_release_held_routes(struct vrf *vrf)
+{
+    struct route *route;
+    struct nexthop *nh;
+    struct ofproto_route ofp_route;
+    int n_released = 0;
+
+    HMAP_FOR_EACH (route, node, &vrf->all_routes) {
+        if (!route->held) {
+            continue;
+        }
+
+        ofp_route.n_nexthops = 0;
+        HMAP_FOR_EACH (nh, node, &route->nexthops) {
+            vrf_ofproto_update_resolved_nh(
+                vrf, &ofp_route, nh,
+                &ofp_route.nexthops[ofp_route.n_nexthops]);
+        }
+        if (ofp_route.n_nexthops == 0) {
+            HMAP_FOR_EACH (nh, node, &route->nexthops) {
+                if (nh->ip_addr) {
+                    vrf_ofproto_set_nh(vrf, &ofp_route.nexthops[0], nh);
+                    ofp_route.n_nexthops = 1;
+                    break;
+                }
+            }
+        }
+        route->held = false;
+        if (ofp_route.n_nexthops > 0) {
+            COVERAGE_INC(vrf_route_released);
+            vrf_ofproto_route_add(vrf, &ofp_route, route);
+            n_released++;
+        }
+    }
+    return n_released;
+}
+
 /* this function vrf_reconfigure_nexthops handles change in nexthop table
  * After that traverse the route table and look for modification of nexthop
  * for that particular route and modify the route accordingly